@@ -0,0 +1,320 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/*
+ * Request budgets. The pager runs against bench/xshim.o, a fake Xlib
+ * with a stand-in window manager state, so no X server is needed. Every
+ * operation is checked against a maximum number of round trips, requests
+ * and drawing requests, derived from the work the operation needs.
+ * Requests do not include drawing, which grows with the number of
+ * windows drawn. Exits with 1 if any budget is exceeded.
+ */
+
+#include "xshim.h"
+
+#include <pager.h>
+#include <x.h>
+
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/* from main.c */
+char *program_name = NULL;
+int ignore_bad_window = 0;
+
+#define NR_CLIENTS	100
+#define NR_DESKTOPS	4
+
+static struct pager *pager;
+/* found after startup, see find_pager_window() */
+static Window pager_window;
+static Window root;
+/* _NET_SUPPORTING_WM_CHECK */
+static Window check;
+static Window clients[NR_CLIENTS];
+static int nr_clients = 0;
+static int verbose = 0;
+
+static void set_cardinal(Window w, const char *name, unsigned long val)
+{
+	xshim_set_property(w, name, XA_CARDINAL, 32, &val, 1);
+}
+
+static void set_title(Window w, const char *title)
+{
+	xshim_set_property(w, "_NET_WM_NAME", xshim_atom("UTF8_STRING"), 8, title, strlen(title));
+}
+
+static void publish_client_list(void)
+{
+	xshim_set_property(root, "_NET_CLIENT_LIST", XA_WINDOW, 32, clients, nr_clients);
+	xshim_set_property(root, "_NET_CLIENT_LIST_STACKING", XA_WINDOW, 32, clients, nr_clients);
+}
+
+static Window add_client(int desk)
+{
+	Atom type = xshim_atom("_NET_WM_WINDOW_TYPE_NORMAL");
+	Window w;
+	char title[64];
+
+	w = xshim_create_window((nr_clients * 37) % 900, (nr_clients * 53) % 700, 200, 150);
+	set_cardinal(w, "_NET_WM_DESKTOP", desk);
+	xshim_set_property(w, "_NET_WM_WINDOW_TYPE", XA_ATOM, 32, &type, 1);
+	xshim_set_property(w, "_NET_WM_STATE", XA_ATOM, 32, NULL, 0);
+	snprintf(title, sizeof(title), "client %d", nr_clients);
+	set_title(w, title);
+	clients[nr_clients++] = w;
+	return w;
+}
+
+static void wm_setup(void)
+{
+	int i;
+
+	root = DefaultRootWindow(display);
+	check = xshim_create_window(-1, -1, 1, 1);
+	xshim_set_property(check, "_NET_SUPPORTING_WM_CHECK", XA_WINDOW, 32, &check, 1);
+	xshim_set_property(root, "_NET_SUPPORTING_WM_CHECK", XA_WINDOW, 32, &check, 1);
+	set_cardinal(root, "_NET_NUMBER_OF_DESKTOPS", NR_DESKTOPS);
+	set_cardinal(root, "_NET_CURRENT_DESKTOP", 0);
+	set_cardinal(root, "_NET_SHOWING_DESKTOP", 0);
+	for (i = 0; i < NR_CLIENTS - 1; i++)
+		add_client(i % NR_DESKTOPS);
+	publish_client_list();
+	xshim_set_property(root, "_NET_ACTIVE_WINDOW", XA_WINDOW, 32, &clients[0], 1);
+}
+
+static void dispatch(XEvent *e)
+{
+	switch (e->type) {
+	case Expose:
+		pager_expose_event(pager, e);
+		break;
+	case ConfigureNotify:
+		pager_configure_notify(pager, &e->xconfigure);
+		break;
+	case PropertyNotify:
+		pager_property_notify(pager, &e->xproperty);
+		break;
+	}
+}
+
+/* the mapped window which is neither a client nor the WM check window */
+static Window find_pager_window(void)
+{
+	Window r, parent, *children, found = None;
+	unsigned int nr, i;
+	int j;
+
+	if (!XQueryTree(display, root, &r, &parent, &children, &nr))
+		return None;
+	for (i = 0; i < nr && found == None; i++) {
+		XWindowAttributes a;
+
+		for (j = 0; j < nr_clients && clients[j] != children[i]; j++)
+			;
+		if (j == nr_clients && children[i] != check &&
+				XGetWindowAttributes(display, children[i], &a) &&
+				a.map_state == IsViewable)
+			found = children[i];
+	}
+	free(children);
+	return found;
+}
+
+/* until there is nothing to do */
+static void pump(void)
+{
+	do {
+		while (XPending(display)) {
+			XEvent e;
+
+			XNextEvent(display, &e);
+			dispatch(&e);
+		}
+		while (pager_needs_work(pager) && pager_handle_events(pager))
+			;
+	} while (XPending(display));
+}
+
+/* -- operations -- */
+
+static void op_startup(void)
+{
+	pager = pager_new("400x0", -1, -1, 0);
+	if (pager == NULL) {
+		fprintf(stderr, "pager_new failed\n");
+		exit(1);
+	}
+	pager_show(pager);
+}
+
+static void op_focus(void)
+{
+	xshim_set_property(root, "_NET_ACTIVE_WINDOW", XA_WINDOW, 32, &clients[4], 1);
+}
+
+static void op_desktop(void)
+{
+	set_cardinal(root, "_NET_CURRENT_DESKTOP", 1);
+}
+
+static void op_title(void)
+{
+	set_title(clients[5], "vim - budget.c");
+}
+
+static void op_move(void)
+{
+	xshim_move_window(clients[6], 300, 200, 400, 300);
+}
+
+/* ConfigureNotify without a size change, e.g. a restack */
+static void op_restack(void)
+{
+	XWindowAttributes a;
+
+	XGetWindowAttributes(display, pager_window, &a);
+	xshim_reset_counts();
+	xshim_move_window(pager_window, a.x, a.y, a.width, a.height);
+}
+
+static void op_new_client(void)
+{
+	add_client(1);
+	publish_client_list();
+}
+
+static void op_idle(void)
+{
+}
+
+struct op {
+	const char *name;
+	void (*func)(void);
+	unsigned long max_round_trips;
+	/* without drawing */
+	unsigned long max_requests;
+	unsigned long max_draw_requests;
+};
+
+/*
+ * Budgets follow from what an operation has to do, not from what it
+ * happens to cost now.
+ */
+
+/* clients are spread evenly over the desktops */
+#define DESK_WINDOWS		((NR_CLIENTS + NR_DESKTOPS - 1) / NR_DESKTOPS)
+
+/* XGetWindowAttributes (GetWindowAttributes and GetGeometry) and
+ * XTranslateCoordinates */
+#define GEOMETRY_ROUND_TRIPS	3
+/* _NET_WM_VISIBLE_NAME, _NET_WM_NAME and WM_NAME */
+#define TITLE_ROUND_TRIPS	3
+/* desktop probe, window type, states, geometry and title */
+#define FETCH_ROUND_TRIPS	(3 + GEOMETRY_ROUND_TRIPS + TITLE_ROUND_TRIPS)
+/* and XSelectInput */
+#define FETCH_REQUESTS		(FETCH_ROUND_TRIPS + 1)
+/* atoms, colors, fonts, windows and the root properties. does not
+ * depend on the number of clients */
+#define SETUP_ROUND_TRIPS	64
+#define SETUP_REQUESTS		96
+/* REFRESH_BUDGET in pager.c */
+#define REFRESH_BUDGET		64
+
+/* border, inside and the title (extents, clip and string) */
+#define WINDOW_DRAWS		5
+/* XftDrawChange, background, windows and XClearArea */
+#define CELL_DRAWS		(3 + WINDOW_DRAWS * DESK_WINDOWS)
+/* XftDrawChange, backgrounds, extra space, grid lines, windows and
+ * XClearWindow */
+#define PAINT_DRAWS(n)		(4 + 2 * NR_DESKTOPS + WINDOW_DRAWS * (n))
+
+static const struct op ops[] = {
+	/* every client is fetched once. the pager is painted at most once
+	 * per refresh slice */
+	{ "startup",    op_startup,
+		SETUP_ROUND_TRIPS + FETCH_ROUND_TRIPS * (NR_CLIENTS - 1),
+		SETUP_REQUESTS + FETCH_REQUESTS * (NR_CLIENTS - 1),
+		((NR_CLIENTS - 1) * FETCH_REQUESTS / REFRESH_BUDGET + 1) * PAINT_DRAWS(NR_CLIENTS - 1) },
+	/* one property read. the old and new active window are on the
+	 * same desktop, one cell is repainted */
+	{ "focus",      op_focus,       1, 1, CELL_DRAWS },
+	/* one property read, the old and new desktop cells are repainted */
+	{ "desktop",    op_desktop,     1, 1, 2 * CELL_DRAWS },
+	/* the title is read, the cell of the client is repainted */
+	{ "title",      op_title,       TITLE_ROUND_TRIPS, TITLE_ROUND_TRIPS, CELL_DRAWS },
+	/* the geometry is read, the client stays on its desktop */
+	{ "move",       op_move,        GEOMETRY_ROUND_TRIPS, GEOMETRY_ROUND_TRIPS, CELL_DRAWS },
+	/* the client list is read (interning its atom on first use) and
+	 * the new client is fetched. a new client table repaints the
+	 * whole pager */
+	{ "new client", op_new_client,
+		2 + FETCH_ROUND_TRIPS,
+		2 + FETCH_REQUESTS,
+		PAINT_DRAWS(NR_CLIENTS) },
+	/* geometry is read, nothing is drawn */
+	{ "restack",    op_restack,     GEOMETRY_ROUND_TRIPS, GEOMETRY_ROUND_TRIPS, 0 },
+	{ "idle",       op_idle,        0, 0, 0 }
+};
+
+int main(int argc, char *argv[])
+{
+	int i, failed = 0;
+
+	program_name = argv[0];
+	if (argc > 1 && strcmp(argv[1], "-v") == 0)
+		verbose = 1;
+	if (x_init(NULL)) {
+		fprintf(stderr, "%s: x_init failed\n", argv[0]);
+		return 1;
+	}
+	wm_setup();
+
+	for (i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+		const struct op *op = &ops[i];
+		unsigned long requests;
+		int ok;
+
+		xshim_reset_counts();
+		op->func();
+		pump();
+		requests = xshim_counts.requests - xshim_counts.draw_requests;
+		ok = xshim_counts.round_trips <= op->max_round_trips &&
+			requests <= op->max_requests &&
+			xshim_counts.draw_requests <= op->max_draw_requests;
+		printf("%-12s %4lu round trips (max %4lu) %4lu requests (max %4lu) %5lu draws (max %5lu) %s\n",
+				op->name,
+				xshim_counts.round_trips, op->max_round_trips,
+				requests, op->max_requests,
+				xshim_counts.draw_requests, op->max_draw_requests,
+				ok ? "ok" : "FAIL");
+		if (verbose || !ok)
+			xshim_print_calls(stdout);
+		if (!ok)
+			failed = 1;
+		if (op->func == op_startup)
+			pager_window = find_pager_window();
+	}
+
+	pager_delete(pager);
+	x_exit();
+	return failed;
+}
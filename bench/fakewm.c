@@ -0,0 +1,803 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/*
+ * Minimal stand-in EWMH window manager for benchmarking netwmpager.
+ *
+ * Creates N dummy clients, reparents each one into a frame window like a
+ * real window manager, publishes the root window properties a pager
+ * needs, starts the pager and then drives one scenario:
+ *
+ *   desktop  _NET_CURRENT_DESKTOP changes
+ *   focus    _NET_ACTIVE_WINDOW changes
+ *   title    _NET_WM_NAME of clients changes
+ *   move     frames are moved, clients get a synthetic ConfigureNotify
+ *   click    storm of title changes with a synthetic click on the pager
+ *            every few steps, reports the pager's click latency
+ *   churn    all of the above for -t seconds: clients are destroyed and
+ *            created, some titles change every 20 ms and the desktop
+ *            flips. checks CPU, wakeup and memory budgets
+ *
+ * netwmpager must be built with DEBUG > 0. The scenario starts when the
+ * stats dumped (SIGUSR1) to $NETWMPAGER_STATS show a finished refresh.
+ * The stats are reset (SIGUSR2) when the scenario starts and dumped again
+ * when it ends. One JSON object per run is printed to stdout.
+ */
+
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+enum {
+	CHECK,
+	NR_DESKTOPS,
+	LAYOUT,
+	CURRENT,
+	ACTIVE,
+	SHOWING,
+	CLIENT_LIST,
+	STACKING,
+	WM_DESKTOP,
+	WM_NAME,
+	WM_STATE,
+	WM_TYPE,
+	WM_TYPE_NORMAL,
+	UTF8,
+	NR_ATOMS
+};
+
+static const char *atom_names[NR_ATOMS] = {
+	"_NET_SUPPORTING_WM_CHECK",
+	"_NET_NUMBER_OF_DESKTOPS",
+	"_NET_DESKTOP_LAYOUT",
+	"_NET_CURRENT_DESKTOP",
+	"_NET_ACTIVE_WINDOW",
+	"_NET_SHOWING_DESKTOP",
+	"_NET_CLIENT_LIST",
+	"_NET_CLIENT_LIST_STACKING",
+	"_NET_WM_DESKTOP",
+	"_NET_WM_NAME",
+	"_NET_WM_STATE",
+	"_NET_WM_WINDOW_TYPE",
+	"_NET_WM_WINDOW_TYPE_NORMAL",
+	"UTF8_STRING"
+};
+
+static Display *display;
+static Window root;
+static Atom atoms[NR_ATOMS];
+
+static Window *clients;
+/* parents of clients[] */
+static Window *frames;
+static int nr_clients = 100;
+static int nr_desktops = 4;
+static int iterations = 200;
+/* delay between scenario steps */
+static int step_us = 2000;
+static const char *scenario = "desktop";
+static const char *stats_file = "/tmp/netwmpager-bench.stats";
+
+/* churn: run time in seconds and budgets */
+static int duration = 600;
+static int max_cpu_pct = 10;
+static int max_leak_kb = 1024;
+
+/* churn: per 20 ms tick */
+#define CHURN_TICK_US		20000
+/* clients replaced by new windows */
+#define CHURN_REPLACE		2
+/* clients with a title which changes every tick, like a terminal */
+#define CHURN_TITLES		10
+/* ticks between desktop switches */
+#define CHURN_DESKTOP_TICKS	5
+
+/* for the pager to map its window, finish a refresh or dump its stats */
+#define WAIT_US			30000000ULL
+
+/* click: titles changed per step and steps between clicks */
+#define STORM_TITLES		20
+#define CLICK_STEPS		5
+
+static pid_t pager_pid = -1;
+/* first window mapped through MapRequest */
+static Window pager_window = None;
+
+static unsigned long long time_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void set_cardinals(Window w, int atom, const unsigned long *data, int nr)
+{
+	XChangeProperty(display, w, atoms[atom], XA_CARDINAL, 32, PropModeReplace,
+			(const unsigned char *)data, nr);
+}
+
+static void set_cardinal(Window w, int atom, unsigned long val)
+{
+	set_cardinals(w, atom, &val, 1);
+}
+
+static void set_window(Window w, int atom, Window val)
+{
+	XChangeProperty(display, w, atoms[atom], XA_WINDOW, 32, PropModeReplace,
+			(const unsigned char *)&val, 1);
+}
+
+static void set_name(Window w, const char *name)
+{
+	XChangeProperty(display, w, atoms[WM_NAME], atoms[UTF8], 8, PropModeReplace,
+			(const unsigned char *)name, strlen(name));
+}
+
+static void publish_client_list(void)
+{
+	XChangeProperty(display, root, atoms[CLIENT_LIST], XA_WINDOW, 32, PropModeReplace,
+			(const unsigned char *)clients, nr_clients);
+	XChangeProperty(display, root, atoms[STACKING], XA_WINDOW, 32, PropModeReplace,
+			(const unsigned char *)clients, nr_clients);
+}
+
+/* client position inside its frame */
+#define FRAME_BORDER	2
+#define FRAME_TITLE	18
+
+#define CLIENT_W	200
+#define CLIENT_H	150
+
+/* creates a client and its frame, sets clients[@k] and frames[@k] */
+static void create_client(int k, int i)
+{
+	Atom type = atoms[WM_TYPE_NORMAL];
+	char name[64];
+	Window w, frame;
+
+	/* as the application would, then managed by us */
+	w = XCreateSimpleWindow(display, root, 0, 0, CLIENT_W, CLIENT_H, 0, 0, 0);
+	set_cardinal(w, WM_DESKTOP, i % nr_desktops);
+	snprintf(name, sizeof(name), "client %d", i);
+	set_name(w, name);
+	XChangeProperty(display, w, atoms[WM_STATE], XA_ATOM, 32,
+			PropModeReplace, NULL, 0);
+	XChangeProperty(display, w, atoms[WM_TYPE], XA_ATOM, 32,
+			PropModeReplace, (unsigned char *)&type, 1);
+
+	frame = XCreateSimpleWindow(display, root, (i * 37) % 900, (i * 53) % 700,
+			CLIENT_W + 2 * FRAME_BORDER, CLIENT_H + FRAME_TITLE + FRAME_BORDER,
+			0, 0, 0);
+	XReparentWindow(display, w, frame, FRAME_BORDER, FRAME_TITLE);
+	XMapWindow(display, w);
+	XMapWindow(display, frame);
+	clients[k] = w;
+	frames[k] = frame;
+}
+
+static void destroy_client(int k)
+{
+	/* destroys the client too */
+	XDestroyWindow(display, frames[k]);
+}
+
+/* moves frame. the client does not move relative to its parent so it
+ * gets a synthetic ConfigureNotify with root coordinates (ICCCM 4.1.5) */
+static void move_client(int k, int x, int y)
+{
+	XEvent e;
+
+	XMoveWindow(display, frames[k], x, y);
+
+	memset(&e, 0, sizeof(e));
+	e.xconfigure.type = ConfigureNotify;
+	e.xconfigure.event = clients[k];
+	e.xconfigure.window = clients[k];
+	e.xconfigure.x = x + FRAME_BORDER;
+	e.xconfigure.y = y + FRAME_TITLE;
+	e.xconfigure.width = CLIENT_W;
+	e.xconfigure.height = CLIENT_H;
+	e.xconfigure.border_width = 0;
+	e.xconfigure.above = None;
+	e.xconfigure.override_redirect = False;
+	XSendEvent(display, clients[k], False, StructureNotifyMask, &e);
+}
+
+static void setup(void)
+{
+	Window check;
+	int i;
+
+	XInternAtoms(display, (char **)atom_names, NR_ATOMS, False, atoms);
+
+	/* become the window manager */
+	XSelectInput(display, root, SubstructureRedirectMask | SubstructureNotifyMask);
+	XSync(display, False);
+
+	check = XCreateSimpleWindow(display, root, -1, -1, 1, 1, 0, 0, 0);
+	set_window(check, CHECK, check);
+	set_window(root, CHECK, check);
+	set_cardinal(root, NR_DESKTOPS, nr_desktops);
+	set_cardinal(root, CURRENT, 0);
+	set_cardinal(root, SHOWING, 0);
+
+	clients = malloc(sizeof(Window) * nr_clients);
+	frames = malloc(sizeof(Window) * nr_clients);
+	for (i = 0; i < nr_clients; i++)
+		create_client(i, i);
+	publish_client_list();
+	set_window(root, ACTIVE, clients[0]);
+	XSync(display, False);
+}
+
+/* requests from the pager */
+static void handle_event(XEvent *e)
+{
+	XWindowChanges wc;
+
+	switch (e->type) {
+	case MapRequest:
+		if (pager_window == None)
+			pager_window = e->xmaprequest.window;
+		XMapWindow(display, e->xmaprequest.window);
+		break;
+	case ConfigureRequest:
+		wc.x = e->xconfigurerequest.x;
+		wc.y = e->xconfigurerequest.y;
+		wc.width = e->xconfigurerequest.width;
+		wc.height = e->xconfigurerequest.height;
+		wc.border_width = e->xconfigurerequest.border_width;
+		wc.sibling = e->xconfigurerequest.above;
+		wc.stack_mode = e->xconfigurerequest.detail;
+		XConfigureWindow(display, e->xconfigurerequest.window,
+				e->xconfigurerequest.value_mask, &wc);
+		break;
+	case ClientMessage:
+		if (e->xclient.message_type == atoms[CURRENT])
+			set_cardinal(root, CURRENT, e->xclient.data.l[0]);
+		else if (e->xclient.message_type == atoms[ACTIVE])
+			set_window(root, ACTIVE, e->xclient.window);
+		else if (e->xclient.message_type == atoms[NR_DESKTOPS])
+			set_cardinal(root, NR_DESKTOPS, e->xclient.data.l[0]);
+		break;
+	}
+}
+
+/* handles events for @us microseconds */
+static void pump(unsigned long long us)
+{
+	unsigned long long end = time_us() + us;
+
+	while (1) {
+		struct pollfd pfd;
+		unsigned long long now;
+
+		while (XPending(display)) {
+			XEvent e;
+
+			XNextEvent(display, &e);
+			handle_event(&e);
+		}
+		now = time_us();
+		if (now >= end)
+			break;
+		pfd.fd = ConnectionNumber(display);
+		pfd.events = POLLIN;
+		poll(&pfd, 1, (end - now + 999) / 1000);
+	}
+}
+
+/* press and release button 1 at @x, @y of the pager window */
+static void click(int x, int y)
+{
+	XEvent e;
+	int i;
+
+	memset(&e, 0, sizeof(e));
+	e.xbutton.window = pager_window;
+	e.xbutton.root = root;
+	e.xbutton.x = x;
+	e.xbutton.y = y;
+	e.xbutton.button = Button1;
+	e.xbutton.same_screen = True;
+	for (i = 0; i < 2; i++) {
+		e.type = i ? ButtonRelease : ButtonPress;
+		XSendEvent(display, pager_window, False,
+				i ? ButtonReleaseMask : ButtonPressMask, &e);
+	}
+}
+
+static void click_step(int i)
+{
+	char name[64];
+	int j;
+
+	for (j = 0; j < STORM_TITLES && j < nr_clients; j++) {
+		int k = (i * STORM_TITLES + j) % nr_clients;
+
+		snprintf(name, sizeof(name), "client %d #%d", k, i);
+		set_name(clients[k], name);
+	}
+	if (i % CLICK_STEPS == 0 && pager_window != None) {
+		Window r;
+		int x, y;
+		unsigned int w, h, bw, depth;
+
+		/* across the pager, one click per desktop cell */
+		if (XGetGeometry(display, pager_window, &r, &x, &y, &w, &h, &bw, &depth)) {
+			int n = i / CLICK_STEPS % (2 * nr_desktops);
+
+			click(n * w / (2 * nr_desktops) + 1, h / 2);
+		}
+	}
+}
+
+static void step(int i)
+{
+	int k = i % nr_clients;
+	Window w = clients[k];
+	char name[64];
+
+	if (strcmp(scenario, "desktop") == 0) {
+		set_cardinal(root, CURRENT, (i + 1) % nr_desktops);
+	} else if (strcmp(scenario, "focus") == 0) {
+		set_window(root, ACTIVE, w);
+	} else if (strcmp(scenario, "title") == 0) {
+		snprintf(name, sizeof(name), "client %d #%d", k, i);
+		set_name(w, name);
+	} else if (strcmp(scenario, "move") == 0) {
+		move_client(k, (i * 17) % 900, (i * 29) % 700);
+	} else if (strcmp(scenario, "click") == 0) {
+		click_step(i);
+	}
+	XFlush(display);
+}
+
+/* user + system time of the pager in milliseconds */
+static unsigned long cpu_ms(void)
+{
+	char path[64], buf[1024], *p;
+	unsigned long utime, stime;
+	FILE *f;
+	int i;
+
+	snprintf(path, sizeof(path), "/proc/%d/stat", (int)pager_pid);
+	f = fopen(path, "r");
+	if (f == NULL)
+		return 0;
+	if (fgets(buf, sizeof(buf), f) == NULL) {
+		fclose(f);
+		return 0;
+	}
+	fclose(f);
+
+	/* fields 14 and 15, after "(comm)" */
+	p = strrchr(buf, ')');
+	if (p == NULL)
+		return 0;
+	for (i = 0; i < 12 && p; i++)
+		p = strchr(p + 1, ' ');
+	if (p == NULL || sscanf(p, "%lu %lu", &utime, &stime) != 2)
+		return 0;
+	return (utime + stime) * 1000 / sysconf(_SC_CLK_TCK);
+}
+
+/* value of @key in /proc/PID/status, "VmRSS" is in kB */
+static unsigned long proc_status(const char *key)
+{
+	char path[64], line[256];
+	unsigned long val = 0;
+	size_t len = strlen(key);
+	FILE *f;
+
+	snprintf(path, sizeof(path), "/proc/%d/status", (int)pager_pid);
+	f = fopen(path, "r");
+	if (f == NULL)
+		return 0;
+	while (fgets(line, sizeof(line), f)) {
+		if (strncmp(line, key, len) == 0 && line[len] == ':') {
+			val = strtoul(line + len + 1, NULL, 10);
+			break;
+		}
+	}
+	fclose(f);
+	return val;
+}
+
+static void start_pager(char **argv)
+{
+	pager_pid = fork();
+	if (pager_pid == 0) {
+		setenv("NETWMPAGER_STATS", stats_file, 1);
+		execvp(argv[0], argv);
+		perror(argv[0]);
+		_exit(127);
+	}
+}
+
+/* prints stats dumped by the pager as JSON members */
+static void print_stats(void)
+{
+	char line[256];
+	FILE *f;
+
+	f = fopen(stats_file, "r");
+	if (f == NULL)
+		return;
+	while (fgets(line, sizeof(line), f)) {
+		unsigned long val, n, avg, p50, p99, max;
+		char key[64];
+
+		char *s;
+
+		if (sscanf(line, "%63[a-z ]: n=%lu avg=%lu p50=%lu p99=%lu max=%lu",
+					key, &n, &avg, &p50, &p99, &max) == 6) {
+			if (strcmp(key, "event to paint") == 0)
+				printf(", \"paints\": %lu", n);
+			for (s = key; *s; s++) {
+				if (*s == ' ')
+					*s = '_';
+			}
+			if (strcmp(key, "event_to_paint") != 0)
+				printf(", \"%s_n\": %lu", key, n);
+			printf(", \"%s_avg_us\": %lu, \"%s_p50_us\": %lu"
+					", \"%s_p99_us\": %lu, \"%s_max_us\": %lu",
+					key, avg, key, p50, key, p99, key, max);
+		} else if (sscanf(line, "%63[a-z ]: %lu", key, &val) == 2) {
+			for (s = key; *s; s++) {
+				if (*s == ' ')
+					*s = '_';
+			}
+			printf(", \"%s\": %lu", key, val);
+		}
+	}
+	fclose(f);
+}
+
+/* sum of the "now" column of the memory table in the stats file */
+static long heap_bytes(void)
+{
+	char line[256];
+	long sum = 0;
+	int in_table = 0;
+	FILE *f;
+
+	f = fopen(stats_file, "r");
+	if (f == NULL)
+		return -1;
+	while (fgets(line, sizeof(line), f)) {
+		long now, max;
+		char name[64];
+
+		if (strncmp(line, "memory:", 7) == 0) {
+			in_table = 1;
+			sum = 0;
+		} else if (in_table && sscanf(line, " %63[a-z ] %ld %ld", name, &now, &max) == 3) {
+			sum += now;
+		} else {
+			in_table = 0;
+		}
+	}
+	fclose(f);
+	return sum;
+}
+
+/* the last line of the stats file is the empty one which ends a dump */
+static int dump_complete(void)
+{
+	char line[256];
+	int empty = 0;
+	FILE *f;
+
+	f = fopen(stats_file, "r");
+	if (f == NULL)
+		return 0;
+	while (fgets(line, sizeof(line), f))
+		empty = strcmp(line, "\n") == 0;
+	fclose(f);
+	return empty;
+}
+
+/* makes the pager dump its stats to a fresh file and waits for it,
+ * returns 0 on timeout */
+static int dump_stats(void)
+{
+	unsigned long long end = time_us() + WAIT_US;
+
+	unlink(stats_file);
+	kill(pager_pid, SIGUSR1);
+	while (!dump_complete()) {
+		if (time_us() >= end) {
+			fprintf(stderr, "no stats from the pager, is it built with --dev?\n");
+			return 0;
+		}
+		pump(10000);
+	}
+	return 1;
+}
+
+static long dump_heap_bytes(void)
+{
+	if (!dump_stats())
+		return -1;
+	return heap_bytes();
+}
+
+/* "refreshes" of the last dump */
+static unsigned long dumped_refreshes(void)
+{
+	char line[256];
+	unsigned long val = 0;
+	FILE *f;
+
+	f = fopen(stats_file, "r");
+	if (f == NULL)
+		return 0;
+	while (fgets(line, sizeof(line), f))
+		sscanf(line, "refreshes: %lu", &val);
+	fclose(f);
+	return val;
+}
+
+/*
+ * The pager installs its signal handlers before it maps its window and
+ * counts a refresh when all clients are fetched. Returns 0 on timeout.
+ */
+static int wait_pager_ready(void)
+{
+	unsigned long long end = time_us() + WAIT_US;
+
+	while (pager_window == None) {
+		if (time_us() >= end) {
+			fprintf(stderr, "the pager did not map its window\n");
+			return 0;
+		}
+		pump(10000);
+	}
+	while (1) {
+		if (!dump_stats())
+			return 0;
+		if (dumped_refreshes())
+			return 1;
+		if (time_us() >= end) {
+			fprintf(stderr, "the initial refresh did not finish\n");
+			return 0;
+		}
+		pump(100000);
+	}
+}
+
+/* one 20 ms tick of the churn scenario */
+static void churn_tick(int tick)
+{
+	/* names of new clients continue after the initial ones */
+	int id = nr_clients + tick * CHURN_REPLACE;
+	char name[64];
+	int i;
+
+	for (i = 0; i < CHURN_REPLACE; i++) {
+		int k = (tick * CHURN_REPLACE + i) % nr_clients;
+
+		destroy_client(k);
+		create_client(k, id + i);
+	}
+	publish_client_list();
+
+	for (i = 0; i < CHURN_TITLES && i < nr_clients; i++) {
+		snprintf(name, sizeof(name), "user@host:~/src/%d$ %d", i, tick % 1000);
+		set_name(clients[i], name);
+	}
+
+	if (tick % CHURN_DESKTOP_TICKS == 0)
+		set_cardinal(root, CURRENT, (tick / CHURN_DESKTOP_TICKS) % nr_desktops);
+	XFlush(display);
+}
+
+/* ticks for @seconds starting from tick @tick, returns next tick */
+static int churn_for(int tick, int seconds)
+{
+	unsigned long long next = time_us();
+	unsigned long long end = next + (unsigned long long)seconds * 1000000;
+
+	while (next < end) {
+		unsigned long long now;
+
+		churn_tick(tick++);
+		next += CHURN_TICK_US;
+		now = time_us();
+		if (next > now)
+			pump(next - now);
+	}
+	return tick;
+}
+
+/*
+ * Runs for @duration seconds. The first tenth (at most a minute) is warm
+ * up so that the allocator and the server reach a steady state, RSS and
+ * heap growth are measured from there. Voluntary context switches are
+ * counted as wakeups: the pager only gives up the CPU when it blocks in
+ * poll().
+ */
+static int churn(void)
+{
+	unsigned long long start, wall;
+	unsigned long cpu, rss0, rss1, vcsw, ivcsw;
+	long heap0, heap1;
+	int warmup = duration / 10 < 60 ? duration / 10 : 60;
+	int tick, cpu_pct, failed = 0;
+
+	tick = churn_for(0, warmup);
+	heap0 = dump_heap_bytes();
+	rss0 = proc_status("VmRSS");
+	kill(pager_pid, SIGUSR2);
+
+	cpu = cpu_ms();
+	vcsw = proc_status("voluntary_ctxt_switches");
+	ivcsw = proc_status("nonvoluntary_ctxt_switches");
+	start = time_us();
+	tick = churn_for(tick, duration - warmup);
+	/* let the pager catch up */
+	pump(500000);
+	wall = time_us() - start;
+	cpu = cpu_ms() - cpu;
+	vcsw = proc_status("voluntary_ctxt_switches") - vcsw;
+	ivcsw = proc_status("nonvoluntary_ctxt_switches") - ivcsw;
+	rss1 = proc_status("VmRSS");
+	heap1 = dump_heap_bytes();
+
+	cpu_pct = wall ? cpu * 100000 / wall : 0;
+	printf("{\"bench\": \"wm\", \"scenario\": \"churn\", \"clients\": %d, \"desktops\": %d"
+			", \"seconds\": %d, \"ticks\": %d, \"windows_created\": %d"
+			", \"wall_ms\": %llu, \"cpu_ms\": %lu, \"cpu_pct\": %d"
+			", \"voluntary_ctxt_switches\": %lu, \"nonvoluntary_ctxt_switches\": %lu"
+			", \"wakeups_per_s\": %llu, \"rss_start_kb\": %lu, \"rss_end_kb\": %lu"
+			", \"heap_start\": %ld, \"heap_end\": %ld",
+			nr_clients, nr_desktops, duration, tick, tick * CHURN_REPLACE,
+			wall / 1000, cpu, cpu_pct, vcsw, ivcsw,
+			wall ? vcsw * 1000000ULL / wall : 0, rss0, rss1, heap0, heap1);
+	print_stats();
+	printf("}\n");
+
+	if (cpu_pct > max_cpu_pct) {
+		fprintf(stderr, "churn: CPU %d%% > %d%%\n", cpu_pct, max_cpu_pct);
+		failed = 1;
+	}
+	if (rss1 > rss0 + max_leak_kb) {
+		fprintf(stderr, "churn: RSS grew by %lu kB > %d kB\n", rss1 - rss0, max_leak_kb);
+		failed = 1;
+	}
+	if (heap0 < 0 || heap1 < 0) {
+		fprintf(stderr, "churn: no memory stats, is the pager built with --dev?\n");
+		failed = 1;
+	} else if (heap1 > heap0 + max_leak_kb * 1024L) {
+		fprintf(stderr, "churn: heap grew by %ld bytes > %d kB\n", heap1 - heap0, max_leak_kb);
+		failed = 1;
+	}
+	return failed;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [-n clients] [-d desktops] [-i iterations] [-u step_us]\n"
+			"          [-s desktop|focus|title|move|click|churn] [-o statsfile]\n"
+			"          [-t seconds] [-c max_cpu_pct] [-l max_leak_kb] -- pager [args]...\n",
+			name);
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned long long start, wall;
+	unsigned long cpu;
+	int c, i, status, failed = 0;
+
+	while ((c = getopt(argc, argv, "n:d:i:u:s:o:t:c:l:")) != -1) {
+		switch (c) {
+		case 'n':
+			nr_clients = atoi(optarg);
+			break;
+		case 'd':
+			nr_desktops = atoi(optarg);
+			break;
+		case 'i':
+			iterations = atoi(optarg);
+			break;
+		case 'u':
+			step_us = atoi(optarg);
+			break;
+		case 's':
+			scenario = optarg;
+			break;
+		case 'o':
+			stats_file = optarg;
+			break;
+		case 't':
+			duration = atoi(optarg);
+			break;
+		case 'c':
+			max_cpu_pct = atoi(optarg);
+			break;
+		case 'l':
+			max_leak_kb = atoi(optarg);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (optind >= argc || nr_clients < 1 || nr_desktops < 1 || duration < 1)
+		usage(argv[0]);
+
+	display = XOpenDisplay(NULL);
+	if (display == NULL) {
+		fprintf(stderr, "%s: cannot open display\n", argv[0]);
+		return 1;
+	}
+	root = DefaultRootWindow(display);
+	setup();
+
+	unlink(stats_file);
+	start_pager(argv + optind);
+
+	if (!wait_pager_ready()) {
+		failed = 1;
+		goto out;
+	}
+	kill(pager_pid, SIGUSR2);
+	pump(100000);
+
+	if (strcmp(scenario, "churn") == 0) {
+		failed = churn();
+		goto out;
+	}
+
+	cpu = cpu_ms();
+	start = time_us();
+	for (i = 0; i < iterations; i++) {
+		step(i);
+		pump(step_us);
+	}
+	/* let the pager catch up */
+	pump(500000);
+	wall = time_us() - start;
+	cpu = cpu_ms() - cpu;
+
+	if (!dump_stats()) {
+		failed = 1;
+		goto out;
+	}
+
+	printf("{\"bench\": \"wm\", \"scenario\": \"%s\", \"clients\": %d, \"desktops\": %d, \"iterations\": %d"
+			", \"wall_ms\": %llu, \"cpu_ms\": %lu",
+			scenario, nr_clients, nr_desktops, iterations, wall / 1000, cpu);
+	print_stats();
+	printf("}\n");
+out:
+	kill(pager_pid, SIGTERM);
+	waitpid(pager_pid, &status, 0);
+	XCloseDisplay(display);
+	return failed;
+}
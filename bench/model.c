@@ -0,0 +1,302 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/*
+ * Model throughput and fuzz test. Random input events, client table
+ * changes and repaints are fed to model.c, which is linked without Xlib.
+ * Invariants are checked after every event and the program aborts on
+ * the first violation.
+ *
+ * Prints one JSON object.
+ */
+
+#include <model.h>
+#include <grid.h>
+#include <xmalloc.h>
+
+#include <sys/time.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/* from main.c */
+char *program_name = NULL;
+
+#define ROOT_W		1280
+#define ROOT_H		1024
+#define NR_CLIENTS	200
+
+static unsigned int seed = 1;
+
+static int rnd(int max)
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) % max;
+}
+
+static unsigned long long now_us(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000ULL + tv.tv_usec;
+}
+
+static void fail(const char *msg, unsigned long event)
+{
+	fprintf(stderr, "%s: event %lu (seed %u): %s\n", program_name, event, seed, msg);
+	abort();
+}
+
+static void random_client(struct model_client *c, unsigned long window, int nr_desks)
+{
+	static const enum window_type types[] = {
+		WINDOW_TYPE_NORMAL, WINDOW_TYPE_NORMAL, WINDOW_TYPE_NORMAL,
+		WINDOW_TYPE_DIALOG, WINDOW_TYPE_DESKTOP, WINDOW_TYPE_DOCK
+	};
+	char name[32];
+
+	memset(c, 0, sizeof(*c));
+	c->window = window;
+	c->w = 1 + rnd(ROOT_W);
+	c->h = 1 + rnd(ROOT_H);
+	c->x = rnd(ROOT_W + 200) - 100;
+	c->y = rnd(ROOT_H + 200) - 100;
+	/* includes desktops which do not exist */
+	c->desk = rnd(nr_desks + 2) - 1;
+	c->type = types[rnd(sizeof(types) / sizeof(types[0]))];
+	if (rnd(8) == 0)
+		c->states |= WINDOW_STATE_SHADED;
+	if (rnd(16) == 0)
+		c->states |= WINDOW_STATE_HIDDEN;
+	snprintf(name, sizeof(name), "client %lu", window);
+	c->name = mem_strdup(MEM_TITLES, name);
+	c->icon_w = -1;
+	c->icon_h = -1;
+}
+
+/* new table, about half of the old clients survive */
+static void random_clients(struct model *m, unsigned long *next_window)
+{
+	int nr = rnd(NR_CLIENTS + 1);
+	struct model_client *clients = mem_new(MEM_CLIENTS, struct model_client, nr);
+	int i;
+
+	for (i = 0; i < nr; i++) {
+		unsigned long window;
+
+		if (m->nr_clients && rnd(2))
+			window = m->clients[rnd(m->nr_clients)].window;
+		else
+			window = (*next_window)++;
+		random_client(&clients[i], window, m->cols * m->rows);
+	}
+	model_replace_clients(m, clients, nr);
+	model_update_rects(m);
+	m->gen++;
+}
+
+/* what a PropertyNotify or ConfigureNotify of one client changes */
+static void random_change(struct model *m)
+{
+	int idx = rnd(m->nr_clients);
+	struct model_client *c = &m->clients[idx];
+	int old_desk = c->desk;
+
+	switch (rnd(3)) {
+	case 0:
+		c->desk = rnd(m->cols * m->rows + 2) - 1;
+		break;
+	case 1:
+		c->x = rnd(ROOT_W + 200) - 100;
+		c->y = rnd(ROOT_H + 200) - 100;
+		break;
+	case 2:
+		c->states ^= WINDOW_STATE_SHADED;
+		break;
+	}
+	model_client_changed(m, idx, old_desk);
+}
+
+static void random_event(struct model *m, struct model_event *e)
+{
+	static const enum model_event_type types[] = {
+		MODEL_MOTION, MODEL_MOTION, MODEL_MOTION, MODEL_MOTION,
+		MODEL_BUTTON_PRESS, MODEL_BUTTON_RELEASE, MODEL_LEAVE
+	};
+
+	e->type = types[rnd(sizeof(types) / sizeof(types[0]))];
+	/* sometimes outside of the pager window */
+	e->x = rnd(m->w + 20) - 10;
+	e->y = rnd(m->h + 20) - 10;
+	e->x_root = e->x;
+	e->y_root = e->y;
+	e->button = 1 + rnd(3);
+}
+
+static void check_rect(const struct model *m, const struct model_rect *r, unsigned long event)
+{
+	if (r->w <= 0 || r->h <= 0)
+		fail("empty rectangle", event);
+	if (r->x < 0 || r->y < 0 || r->x + r->w > m->w || r->y + r->h > m->h)
+		fail("rectangle outside of the pager", event);
+}
+
+static void check_draw(const struct model *m, const struct model_draw_list *list, unsigned long event)
+{
+	int i;
+
+	for (i = 0; i < list->nr; i++) {
+		const struct model_draw *op = &list->ops[i];
+
+		if (op->type == MODEL_FILL)
+			check_rect(m, &op->r, event);
+		if (op->type == MODEL_TEXT) {
+			check_rect(m, &op->clip, event);
+			if (op->text == NULL)
+				fail("text without string", event);
+		}
+	}
+}
+
+/* a grid which is not dirty must give the same answers as walking its
+ * desktop bucket */
+static void check_grids(const struct model *m, unsigned long event)
+{
+	int i, k;
+
+	for (i = 0; i < m->nr_desks; i++) {
+		const struct model_desk *d = &m->desks[i];
+
+		if (d->grid.dirty)
+			continue;
+		for (k = 0; k < 8; k++) {
+			int x = rnd(m->desk_w + 10) - 5;
+			int y = rnd(m->desk_h + 10) - 5;
+			int j, idx = -1;
+
+			for (j = d->nr_windows - 1; j >= 0 && idx == -1; j--) {
+				const struct model_client *c = &m->clients[d->windows[j]];
+
+				if (c->type == WINDOW_TYPE_DESKTOP || (c->states & WINDOW_STATE_HIDDEN))
+					continue;
+				if (x >= c->px && x < c->px + c->pw && y >= c->py && y < c->py + c->ph)
+					idx = d->windows[j];
+			}
+			if (grid_lookup(&d->grid, x, y) != idx)
+				fail("stale hit-test grid", event);
+		}
+	}
+}
+
+static void check(const struct model *m, unsigned long event)
+{
+	int i;
+
+	if (m->mouse.window_idx < -1 || m->mouse.window_idx >= m->nr_clients)
+		fail("dragged window out of range", event);
+	if (m->popup_idx < -1 || m->popup_idx >= m->nr_clients)
+		fail("popup window out of range", event);
+	if (m->mouse.button == -1 && m->mouse.window_idx != -1)
+		fail("dragging without button", event);
+	for (i = 0; i < m->nr_damage; i++) {
+		if (m->damage[i] < 0 || m->damage[i] >= m->cols * m->rows)
+			fail("damaged desktop out of range", event);
+	}
+	for (i = 0; i < m->nr_cmds; i++) {
+		if (m->cmds[i].type == MODEL_POPUP_MOVE && m->popup_idx == -1)
+			fail("popup without window", event);
+	}
+	/* every client is in the bucket of its desktop, in stacking order */
+	for (i = 0; i < m->nr_desks; i++) {
+		const struct model_desk *d = &m->desks[i];
+		int j;
+
+		for (j = 0; j < d->nr_windows; j++) {
+			if (m->clients[d->windows[j]].desk != i - 1)
+				fail("client in wrong desktop bucket", event);
+			if (j && d->windows[j - 1] >= d->windows[j])
+				fail("desktop bucket not in stacking order", event);
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	struct model m;
+	struct model_draw_list list = { NULL, 0, 0 };
+	unsigned long nr_events = 2000000, i;
+	unsigned long next_window = 1, nr_cmds = 0, nr_ops = 0;
+	unsigned long long start, us;
+
+	program_name = argv[0];
+	if (argc > 1)
+		nr_events = strtoul(argv[1], NULL, 10);
+	if (argc > 2)
+		seed = strtoul(argv[2], NULL, 10);
+	if (argc > 3 || nr_events == 0) {
+		fprintf(stderr, "Usage: %s [events [seed]]\n", argv[0]);
+		return 1;
+	}
+
+	model_init(&m, 4, 2, ROOT_W, ROOT_H);
+	model_configure(&m, 400, 2 * 400 * ROOT_H / (4 * ROOT_W));
+	random_clients(&m, &next_window);
+
+	start = now_us();
+	for (i = 0; i < nr_events; i++) {
+		struct model_event e;
+
+		if (rnd(4096) == 0)
+			random_clients(&m, &next_window);
+		if (rnd(64) == 0 && m.nr_clients)
+			random_change(&m);
+		if (rnd(1024) == 0 && m.nr_clients)
+			model_set_active(&m, rnd(m.cols * m.rows), m.clients[rnd(m.nr_clients)].window);
+
+		random_event(&m, &e);
+		model_handle_event(&m, &e);
+		check(&m, i);
+		if (rnd(64) == 0)
+			check_grids(&m, i);
+		nr_cmds += m.nr_cmds;
+		m.nr_cmds = 0;
+
+		/* what the X backend would do after the event */
+		if (m.painted_gen != m.gen) {
+			model_paint(&m, &list);
+		} else {
+			int j;
+
+			for (j = 0; j < m.nr_damage; j++)
+				model_paint_desk(&m, m.damage[j], &list);
+			m.nr_damage = 0;
+		}
+		check_draw(&m, &list, i);
+		nr_ops += list.nr;
+		list.nr = 0;
+	}
+	us = now_us() - start;
+
+	printf("{\"bench\": \"model\", \"events\": %lu, \"us\": %llu, \"events_per_s\": %llu"
+			", \"cmds\": %lu, \"draw_ops\": %lu}\n",
+			nr_events, us, nr_events * 1000000ULL / (us ? us : 1), nr_cmds, nr_ops);
+
+	model_draw_list_free(&list);
+	model_free(&m);
+	return 0;
+}
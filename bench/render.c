@@ -0,0 +1,171 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+/*
+ * Render microbenchmark. pager_update() draws a synthetic client table
+ * into the offscreen pixmap, no window manager is needed. Every frame
+ * ends with XSync so server side rendering time is included.
+ *
+ * Prints one JSON object per configuration.
+ */
+
+#include <pager.h>
+#include <x.h>
+#include <hist.h>
+#include <xmalloc.h>
+
+#include <X11/Xlib.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* from main.c */
+char *program_name = NULL;
+int ignore_bad_window = 0;
+
+static int nr_frames = 200;
+
+struct layout {
+	int cols, rows;
+	const char *geometry;
+};
+
+static const struct layout layouts[] = {
+	{ 4, 1, "400x0" },
+	{ 4, 4, "400x0" },
+	{ 8, 8, "800x0" }
+};
+
+static const int client_counts[] = { 10, 100, 1000 };
+
+/* deterministic pseudo random numbers */
+static unsigned int seed = 1;
+
+static int rnd(int max)
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) % max;
+}
+
+/* @sticky_pct: percentage of sticky clients */
+static struct pager_client *make_clients(int nr, int nr_desks, int sticky_pct,
+		int root_w, int root_h)
+{
+	struct pager_client *clients = xnew(struct pager_client, nr);
+	int i;
+
+	for (i = 0; i < nr; i++) {
+		struct pager_client *c = &clients[i];
+		char name[64];
+
+		c->window = i + 1;
+		c->w = 100 + rnd(root_w / 2);
+		c->h = 80 + rnd(root_h / 2);
+		c->x = rnd(root_w - c->w);
+		c->y = rnd(root_h - c->h);
+		c->desk = rnd(100) < sticky_pct ? -1 : rnd(nr_desks);
+		c->type = WINDOW_TYPE_NORMAL;
+		c->states = 0;
+		snprintf(name, sizeof(name), "client %d - some longer window title", i);
+		c->name = xstrdup(name);
+	}
+	return clients;
+}
+
+static void free_clients(struct pager_client *clients, int nr)
+{
+	int i;
+
+	for (i = 0; i < nr; i++)
+		free((char *)clients[i].name);
+	free(clients);
+}
+
+static void run(const struct layout *l, int nr_clients, int titles, int sticky_pct)
+{
+	struct hist h = HIST_INIT("frame");
+	struct pager_client *clients;
+	struct pager *pager;
+	int i;
+
+	pager = pager_new_offscreen(l->geometry, l->cols, l->rows);
+	if (pager == NULL) {
+		fprintf(stderr, "could not create pager\n");
+		exit(1);
+	}
+	pager_set_show_window_titles(pager, titles);
+
+	/* configure */
+	pager_render(pager);
+
+	clients = make_clients(nr_clients, l->cols * l->rows, sticky_pct,
+			DisplayWidth(display, DefaultScreen(display)),
+			DisplayHeight(display, DefaultScreen(display)));
+	pager_set_clients(pager, clients, nr_clients);
+	pager_set_active(pager, 0, clients[0].window);
+	XSync(display, False);
+
+	for (i = 0; i < nr_frames; i++) {
+		unsigned long long start = time_us();
+
+		/* active window changes every frame */
+		pager_set_active(pager, i % (l->cols * l->rows), clients[i % nr_clients].window);
+		pager_render(pager);
+		XSync(display, False);
+		hist_add(&h, time_us() - start);
+	}
+
+	printf("{\"bench\": \"render\", \"layout\": \"%dx%d\", \"clients\": %d, \"titles\": %d, \"sticky_pct\": %d"
+			", \"frames\": %d, \"us_per_frame\": %llu, \"p50_us\": %u, \"p99_us\": %u, \"max_us\": %u}\n",
+			l->cols, l->rows, nr_clients, titles, sticky_pct, nr_frames,
+			h.sum / h.count, hist_percentile(&h, 50), hist_percentile(&h, 99), h.max);
+	fflush(stdout);
+
+	free_clients(clients, nr_clients);
+	pager_delete(pager);
+}
+
+int main(int argc, char *argv[])
+{
+	int l, c, titles, sticky;
+
+	program_name = argv[0];
+	if (argc > 1)
+		nr_frames = atoi(argv[1]);
+	if (nr_frames < 1) {
+		fprintf(stderr, "Usage: %s [frames]\n", argv[0]);
+		return 1;
+	}
+	if (x_init(NULL)) {
+		fprintf(stderr, "%s: cannot open display\n", argv[0]);
+		return 1;
+	}
+
+	for (l = 0; l < sizeof(layouts) / sizeof(layouts[0]); l++) {
+		for (c = 0; c < sizeof(client_counts) / sizeof(client_counts[0]); c++) {
+			for (titles = 0; titles <= 1; titles++) {
+				/* normal and sticky-heavy workload */
+				for (sticky = 0; sticky <= 50; sticky += 50)
+					run(&layouts[l], client_counts[c], titles, sticky);
+			}
+		}
+	}
+
+	x_exit();
+	return 0;
+}
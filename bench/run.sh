@@ -0,0 +1,50 @@
+#!/bin/sh
+#
+# Runs every scenario of bench/fakewm for 10, 100 and 1000 clients and
+# the bench/render microbenchmark on a private Xvfb server. Prints one
+# JSON object per run.
+#
+# netwmpager must be configured with --dev (DEBUG > 0) so that it
+# keeps stats. Usage: bench/run.sh [netwmpager binary] > results.jsonl
+#
+# Environment: CLIENTS, SCENARIOS, ITERATIONS, BENCH_DISPLAY
+
+PAGER=${1:-./netwmpager}
+CLIENTS=${CLIENTS:-"10 100 1000"}
+SCENARIOS=${SCENARIOS:-"desktop focus title move click"}
+ITERATIONS=${ITERATIONS:-200}
+BENCH_DISPLAY=${BENCH_DISPLAY:-:77}
+
+FAKEWM=$(dirname "$0")/fakewm
+RENDER=$(dirname "$0")/render
+STATS=$(mktemp /tmp/netwmpager-bench.XXXXXX)
+CONFIG=$(mktemp -d /tmp/netwmpager-bench-home.XXXXXX)
+
+Xvfb $BENCH_DISPLAY -screen 0 1280x1024x24 -nolisten tcp >/dev/null 2>&1 &
+XVFB=$!
+trap 'kill $XVFB 2>/dev/null; rm -rf "$STATS" "$CONFIG"' EXIT INT TERM
+
+# wait for the server
+i=0
+while ! DISPLAY=$BENCH_DISPLAY xdpyinfo >/dev/null 2>&1
+do
+	i=$((i + 1))
+	if test $i -gt 50
+	then
+		echo "Xvfb did not start" >&2
+		exit 1
+	fi
+	sleep 0.1
+done
+
+for n in $CLIENTS
+do
+	for s in $SCENARIOS
+	do
+		# empty HOME so that user's config is not used
+		DISPLAY=$BENCH_DISPLAY HOME=$CONFIG $FAKEWM -n $n -i $ITERATIONS \
+			-s $s -o "$STATS" -- "$PAGER" || exit 1
+	done
+done
+
+DISPLAY=$BENCH_DISPLAY HOME=$CONFIG $RENDER || exit 1
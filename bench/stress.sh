@@ -0,0 +1,46 @@
+#!/bin/sh
+#
+# Sustained churn on a private Xvfb server: bench/fakewm -s churn
+# destroys and creates clients, changes titles at 50 Hz and flips
+# desktops for DURATION seconds, then checks the pager's CPU time and
+# RSS / heap growth. Prints one JSON object and exits non-zero if a
+# budget is exceeded.
+#
+# netwmpager must be configured with --dev (DEBUG > 0) so that it
+# keeps stats. Usage: bench/stress.sh [netwmpager binary]
+#
+# Environment: CLIENTS, DESKTOPS, DURATION, MAX_CPU_PCT, MAX_LEAK_KB,
+# BENCH_DISPLAY
+
+PAGER=${1:-./netwmpager}
+CLIENTS=${CLIENTS:-200}
+DESKTOPS=${DESKTOPS:-4}
+DURATION=${DURATION:-600}
+MAX_CPU_PCT=${MAX_CPU_PCT:-10}
+MAX_LEAK_KB=${MAX_LEAK_KB:-1024}
+BENCH_DISPLAY=${BENCH_DISPLAY:-:78}
+
+FAKEWM=$(dirname "$0")/fakewm
+STATS=$(mktemp /tmp/netwmpager-stress.XXXXXX)
+CONFIG=$(mktemp -d /tmp/netwmpager-stress-home.XXXXXX)
+
+Xvfb $BENCH_DISPLAY -screen 0 1280x1024x24 -nolisten tcp >/dev/null 2>&1 &
+XVFB=$!
+trap 'kill $XVFB 2>/dev/null; rm -rf "$STATS" "$CONFIG"' EXIT INT TERM
+
+# wait for the server
+i=0
+while ! DISPLAY=$BENCH_DISPLAY xdpyinfo >/dev/null 2>&1
+do
+	i=$((i + 1))
+	if test $i -gt 50
+	then
+		echo "Xvfb did not start" >&2
+		exit 1
+	fi
+	sleep 0.1
+done
+
+# empty HOME so that user's config is not used
+DISPLAY=$BENCH_DISPLAY HOME=$CONFIG $FAKEWM -s churn -n $CLIENTS -d $DESKTOPS \
+	-t $DURATION -c $MAX_CPU_PCT -l $MAX_LEAK_KB -o "$STATS" -- "$PAGER"
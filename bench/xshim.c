@@ -0,0 +1,952 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include "xshim.h"
+
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <X11/Xutil.h>
+#include <X11/Xft/Xft.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/* opaque in the real headers */
+struct _XGC {
+	XGCValues values;
+};
+
+struct _XftDraw {
+	Drawable drawable;
+	Visual *visual;
+	Colormap colormap;
+};
+
+struct prop {
+	struct prop *next;
+	Atom atom;
+	Atom type;
+	int format;
+	int nr;
+	/* format 32 is stored as longs, like XGetWindowProperty returns it */
+	char *data;
+};
+
+struct win {
+	struct win *next;
+	Window id;
+	Window parent;
+	int x, y, w, h;
+	int mapped;
+	long event_mask;
+	struct prop *props;
+};
+
+#define NR_WIN_HASH 1024
+
+struct xshim_counts xshim_counts;
+
+static struct {
+	const char *name;
+	unsigned long count;
+} calls[64];
+static int nr_calls = 0;
+
+static _XPrivDisplay dpy = NULL;
+static Screen screen;
+static Visual visual;
+
+static struct win *windows[NR_WIN_HASH];
+static XID next_id = 0x200001;
+
+static XEvent *queue = NULL;
+static int queue_head = 0;
+static int queue_nr = 0;
+static int queue_alloc = 0;
+
+/* atoms from Xatom.h the pager uses by name */
+static const struct {
+	const char *name;
+	Atom atom;
+} predefined[] = {
+	{ "ATOM", XA_ATOM },
+	{ "CARDINAL", XA_CARDINAL },
+	{ "PIXMAP", XA_PIXMAP },
+	{ "STRING", XA_STRING },
+	{ "WINDOW", XA_WINDOW },
+	{ "WM_ICON_NAME", XA_WM_ICON_NAME },
+	{ "WM_NAME", XA_WM_NAME },
+	{ "WM_NORMAL_HINTS", XA_WM_NORMAL_HINTS },
+	{ "WM_SIZE_HINTS", XA_WM_SIZE_HINTS }
+};
+
+static char **atom_names = NULL;
+static int nr_atom_names = 0;
+/* first atom after the predefined ones */
+#define FIRST_ATOM (XA_LAST_PREDEFINED + 1)
+
+static void count_call(const char *name, int requests, int round_trips)
+{
+	int i;
+
+	for (i = 0; i < nr_calls; i++) {
+		if (strcmp(calls[i].name, name) == 0)
+			break;
+	}
+	if (i == nr_calls && nr_calls < sizeof(calls) / sizeof(calls[0])) {
+		calls[i].name = name;
+		calls[i].count = 0;
+		nr_calls++;
+	}
+	if (i < nr_calls)
+		calls[i].count++;
+	xshim_counts.requests += requests;
+	xshim_counts.round_trips += round_trips;
+	if (dpy)
+		dpy->request += requests;
+}
+
+#define CALL(requests, round_trips) count_call(__func__, requests, round_trips)
+/* request which only renders */
+#define DRAW_CALL() \
+	do { count_call(__func__, 1, 0); xshim_counts.draw_requests++; } while (0)
+
+void xshim_reset_counts(void)
+{
+	memset(&xshim_counts, 0, sizeof(xshim_counts));
+	nr_calls = 0;
+}
+
+void xshim_print_calls(FILE *f)
+{
+	int i;
+
+	for (i = 0; i < nr_calls; i++)
+		fprintf(f, "  %-26s %lu\n", calls[i].name, calls[i].count);
+}
+
+/* -- windows and properties -- */
+
+static struct win *find_win(Window id)
+{
+	struct win *w;
+
+	for (w = windows[id % NR_WIN_HASH]; w; w = w->next) {
+		if (w->id == id)
+			return w;
+	}
+	return NULL;
+}
+
+static struct win *get_win(Window id)
+{
+	struct win *w = find_win(id);
+
+	if (w == NULL)
+		xshim_counts.errors++;
+	return w;
+}
+
+static struct win *new_win(Window parent, int x, int y, int w, int h)
+{
+	struct win *win = calloc(1, sizeof(*win));
+
+	win->id = next_id++;
+	win->parent = parent;
+	win->x = x;
+	win->y = y;
+	win->w = w;
+	win->h = h;
+	win->next = windows[win->id % NR_WIN_HASH];
+	windows[win->id % NR_WIN_HASH] = win;
+	return win;
+}
+
+static void free_props(struct win *w)
+{
+	while (w->props) {
+		struct prop *p = w->props;
+
+		w->props = p->next;
+		free(p->data);
+		free(p);
+	}
+}
+
+static int prop_size(int format, int nr)
+{
+	if (format == 32)
+		return nr * sizeof(long);
+	if (format == 16)
+		return nr * sizeof(short);
+	return nr;
+}
+
+static XEvent *queue_event(int type, Window window)
+{
+	XEvent *e;
+
+	if (queue_head + queue_nr == queue_alloc) {
+		if (queue_head) {
+			memmove(queue, queue + queue_head, queue_nr * sizeof(XEvent));
+			queue_head = 0;
+		}
+		if (queue_nr == queue_alloc) {
+			queue_alloc = queue_alloc ? queue_alloc * 2 : 64;
+			queue = realloc(queue, queue_alloc * sizeof(XEvent));
+		}
+	}
+	e = &queue[queue_head + queue_nr++];
+	memset(e, 0, sizeof(*e));
+	e->type = type;
+	e->xany.serial = dpy->request;
+	e->xany.display = (Display *)dpy;
+	e->xany.window = window;
+	return e;
+}
+
+static void set_prop(struct win *w, Atom atom, Atom type, int format, const void *data, int nr)
+{
+	struct prop *p;
+	int size = prop_size(format, nr);
+
+	for (p = w->props; p; p = p->next) {
+		if (p->atom == atom)
+			break;
+	}
+	if (p == NULL) {
+		p = calloc(1, sizeof(*p));
+		p->atom = atom;
+		p->next = w->props;
+		w->props = p;
+	}
+	free(p->data);
+	p->type = type;
+	p->format = format;
+	p->nr = nr;
+	p->data = malloc(size + 1);
+	memcpy(p->data, data, size);
+	p->data[size] = 0;
+
+	if (w->event_mask & PropertyChangeMask) {
+		XEvent *e = queue_event(PropertyNotify, w->id);
+
+		e->xproperty.atom = atom;
+		e->xproperty.state = PropertyNewValue;
+	}
+}
+
+static void configure(struct win *w, int x, int y, int width, int height)
+{
+	w->x = x;
+	w->y = y;
+	w->w = width;
+	w->h = height;
+	if (w->event_mask & StructureNotifyMask) {
+		XEvent *e = queue_event(ConfigureNotify, w->id);
+
+		e->xconfigure.window = w->id;
+		e->xconfigure.x = x;
+		e->xconfigure.y = y;
+		e->xconfigure.width = width;
+		e->xconfigure.height = height;
+	}
+}
+
+/* position relative to the root window */
+static void root_pos(struct win *w, int *x, int *y)
+{
+	*x = 0;
+	*y = 0;
+	while (w && w->id != screen.root) {
+		*x += w->x;
+		*y += w->y;
+		w = find_win(w->parent);
+	}
+}
+
+Atom xshim_atom(const char *name)
+{
+	int i;
+
+	for (i = 0; i < sizeof(predefined) / sizeof(predefined[0]); i++) {
+		if (strcmp(predefined[i].name, name) == 0)
+			return predefined[i].atom;
+	}
+	for (i = 0; i < nr_atom_names; i++) {
+		if (strcmp(atom_names[i], name) == 0)
+			return FIRST_ATOM + i;
+	}
+	atom_names = realloc(atom_names, (nr_atom_names + 1) * sizeof(char *));
+	atom_names[nr_atom_names] = strdup(name);
+	return FIRST_ATOM + nr_atom_names++;
+}
+
+Window xshim_create_window(int x, int y, int w, int h)
+{
+	struct win *win = new_win(screen.root, x, y, w, h);
+
+	win->mapped = 1;
+	return win->id;
+}
+
+void xshim_destroy_window(Window window)
+{
+	struct win **wp = &windows[window % NR_WIN_HASH];
+
+	while (*wp) {
+		struct win *w = *wp;
+
+		if (w->id == window) {
+			if (w->event_mask & StructureNotifyMask)
+				queue_event(DestroyNotify, window)->xdestroywindow.window = window;
+			*wp = w->next;
+			free_props(w);
+			free(w);
+			return;
+		}
+		wp = &w->next;
+	}
+}
+
+void xshim_move_window(Window window, int x, int y, int w, int h)
+{
+	struct win *win = find_win(window);
+
+	if (win)
+		configure(win, x, y, w, h);
+}
+
+void xshim_set_property(Window window, const char *name, Atom type, int format,
+		const void *data, int nr)
+{
+	struct win *w = find_win(window);
+
+	if (w)
+		set_prop(w, xshim_atom(name), type, format, data, nr);
+}
+
+/* -- Xlib -- */
+
+Display *XOpenDisplay(_Xconst char *name)
+{
+	struct win *root;
+
+	CALL(0, 1);
+	dpy = calloc(1, sizeof(*dpy));
+	visual.class = TrueColor;
+	visual.red_mask = 0xff0000;
+	visual.green_mask = 0xff00;
+	visual.blue_mask = 0xff;
+	visual.bits_per_rgb = 8;
+	visual.map_entries = 256;
+
+	root = new_win(None, 0, 0, 1280, 1024);
+	root->mapped = 1;
+	memset(&screen, 0, sizeof(screen));
+	screen.display = (Display *)dpy;
+	screen.root = root->id;
+	screen.width = root->w;
+	screen.height = root->h;
+	screen.root_depth = 24;
+	screen.root_visual = &visual;
+	screen.cmap = next_id++;
+
+	dpy->fd = -1;
+	dpy->screens = &screen;
+	dpy->nscreens = 1;
+	dpy->default_screen = 0;
+	return (Display *)dpy;
+}
+
+int XCloseDisplay(Display *d)
+{
+	int i;
+
+	CALL(0, 0);
+	for (i = 0; i < NR_WIN_HASH; i++) {
+		while (windows[i]) {
+			struct win *w = windows[i];
+
+			windows[i] = w->next;
+			free_props(w);
+			free(w);
+		}
+	}
+	for (i = 0; i < nr_atom_names; i++)
+		free(atom_names[i]);
+	free(atom_names);
+	atom_names = NULL;
+	nr_atom_names = 0;
+	free(queue);
+	queue = NULL;
+	queue_head = queue_nr = queue_alloc = 0;
+	free(dpy);
+	dpy = NULL;
+	return 0;
+}
+
+int XFree(void *data)
+{
+	free(data);
+	return 1;
+}
+
+Atom XInternAtom(Display *d, _Xconst char *name, Bool only_if_exists)
+{
+	CALL(1, 1);
+	return xshim_atom(name);
+}
+
+char *XGetAtomName(Display *d, Atom atom)
+{
+	int i;
+
+	CALL(1, 1);
+	for (i = 0; i < sizeof(predefined) / sizeof(predefined[0]); i++) {
+		if (predefined[i].atom == atom)
+			return strdup(predefined[i].name);
+	}
+	if (atom < FIRST_ATOM || atom >= FIRST_ATOM + nr_atom_names)
+		return NULL;
+	return strdup(atom_names[atom - FIRST_ATOM]);
+}
+
+int XFlush(Display *d)
+{
+	CALL(0, 0);
+	return 1;
+}
+
+int XPending(Display *d)
+{
+	CALL(0, 0);
+	return queue_nr;
+}
+
+int XNextEvent(Display *d, XEvent *event)
+{
+	CALL(0, 0);
+	if (queue_nr == 0) {
+		/* nothing would ever arrive */
+		fprintf(stderr, "xshim: XNextEvent with an empty queue\n");
+		abort();
+	}
+	*event = queue[queue_head++];
+	if (--queue_nr == 0)
+		queue_head = 0;
+	return 0;
+}
+
+int XSelectInput(Display *d, Window window, long mask)
+{
+	struct win *w;
+
+	CALL(1, 0);
+	w = get_win(window);
+	if (w)
+		w->event_mask = mask;
+	return 1;
+}
+
+Status XSendEvent(Display *d, Window window, Bool propagate, long mask, XEvent *event)
+{
+	CALL(1, 0);
+	return 1;
+}
+
+int XGetWindowProperty(Display *d, Window window, Atom property,
+		long offset, long length, Bool delete, Atom req_type,
+		Atom *actual_type, int *actual_format,
+		unsigned long *nitems, unsigned long *bytes_after,
+		unsigned char **prop_ret)
+{
+	struct win *w;
+	struct prop *p;
+	int size;
+
+	CALL(1, 1);
+	*actual_type = None;
+	*actual_format = 0;
+	*nitems = 0;
+	*bytes_after = 0;
+	*prop_ret = NULL;
+	w = get_win(window);
+	if (w == NULL)
+		return BadWindow;
+	for (p = w->props; p; p = p->next) {
+		if (p->atom == property)
+			break;
+	}
+	if (p == NULL)
+		return Success;
+
+	*actual_type = p->type;
+	*actual_format = p->format;
+	size = prop_size(p->format, p->nr);
+	if (req_type != AnyPropertyType && req_type != p->type) {
+		*bytes_after = size;
+		return Success;
+	}
+	*nitems = p->nr;
+	*prop_ret = malloc(size + 1);
+	memcpy(*prop_ret, p->data, size + 1);
+	return Success;
+}
+
+int XChangeProperty(Display *d, Window window, Atom property, Atom type,
+		int format, int mode, _Xconst unsigned char *data, int nr)
+{
+	struct win *w;
+
+	CALL(1, 0);
+	w = get_win(window);
+	if (w)
+		set_prop(w, property, type, format, data, nr);
+	return 1;
+}
+
+Status XGetWindowAttributes(Display *d, Window window, XWindowAttributes *attr)
+{
+	struct win *w;
+
+	/* GetWindowAttributes + GetGeometry */
+	CALL(2, 2);
+	w = get_win(window);
+	if (w == NULL)
+		return 0;
+	memset(attr, 0, sizeof(*attr));
+	attr->x = w->x;
+	attr->y = w->y;
+	attr->width = w->w;
+	attr->height = w->h;
+	attr->depth = screen.root_depth;
+	attr->visual = &visual;
+	attr->root = screen.root;
+	attr->class = InputOutput;
+	attr->colormap = screen.cmap;
+	attr->map_state = w->mapped ? IsViewable : IsUnmapped;
+	attr->your_event_mask = w->event_mask;
+	attr->screen = &screen;
+	return 1;
+}
+
+Bool XTranslateCoordinates(Display *d, Window src, Window dest, int src_x, int src_y,
+		int *dest_x, int *dest_y, Window *child)
+{
+	struct win *s, *t;
+	int sx, sy, tx, ty;
+
+	CALL(1, 1);
+	s = get_win(src);
+	t = get_win(dest);
+	if (s == NULL || t == NULL)
+		return False;
+	root_pos(s, &sx, &sy);
+	root_pos(t, &tx, &ty);
+	*dest_x = src_x + sx - tx;
+	*dest_y = src_y + sy - ty;
+	*child = None;
+	return True;
+}
+
+Status XQueryTree(Display *d, Window window, Window *root, Window *parent,
+		Window **children, unsigned int *nr)
+{
+	struct win *w;
+	int i;
+
+	CALL(1, 1);
+	w = get_win(window);
+	if (w == NULL)
+		return 0;
+	*root = screen.root;
+	*parent = w->parent;
+	*children = NULL;
+	*nr = 0;
+	for (i = 0; i < NR_WIN_HASH; i++) {
+		struct win *c;
+
+		for (c = windows[i]; c; c = c->next) {
+			if (c->parent != window)
+				continue;
+			*children = realloc(*children, (*nr + 1) * sizeof(Window));
+			(*children)[(*nr)++] = c->id;
+		}
+	}
+	return 1;
+}
+
+Window XCreateWindow(Display *d, Window parent, int x, int y,
+		unsigned int w, unsigned int h, unsigned int border, int depth,
+		unsigned int class, Visual *v, unsigned long mask,
+		XSetWindowAttributes *attr)
+{
+	struct win *win;
+
+	CALL(1, 0);
+	win = new_win(parent, x, y, w, h);
+	if (mask & CWEventMask)
+		win->event_mask = attr->event_mask;
+	return win->id;
+}
+
+int XDestroyWindow(Display *d, Window window)
+{
+	CALL(1, 0);
+	xshim_destroy_window(window);
+	return 1;
+}
+
+static int map(Window window, int mapped)
+{
+	struct win *w = get_win(window);
+
+	if (w && w->mapped != mapped) {
+		w->mapped = mapped;
+		if (w->event_mask & StructureNotifyMask) {
+			XEvent *e = queue_event(mapped ? MapNotify : UnmapNotify, window);
+
+			/* same offset in XMapEvent and XUnmapEvent */
+			e->xmap.window = window;
+		}
+		if (mapped && (w->event_mask & ExposureMask)) {
+			XEvent *e = queue_event(Expose, window);
+
+			e->xexpose.width = w->w;
+			e->xexpose.height = w->h;
+		}
+	}
+	return 1;
+}
+
+int XMapWindow(Display *d, Window window)
+{
+	CALL(1, 0);
+	return map(window, 1);
+}
+
+int XMapRaised(Display *d, Window window)
+{
+	/* ConfigureWindow + MapWindow */
+	CALL(2, 0);
+	return map(window, 1);
+}
+
+int XUnmapWindow(Display *d, Window window)
+{
+	CALL(1, 0);
+	return map(window, 0);
+}
+
+int XMoveResizeWindow(Display *d, Window window, int x, int y, unsigned int w, unsigned int h)
+{
+	struct win *win;
+
+	CALL(1, 0);
+	win = get_win(window);
+	if (win)
+		configure(win, x, y, w, h);
+	return 1;
+}
+
+int XConfigureWindow(Display *d, Window window, unsigned int mask, XWindowChanges *changes)
+{
+	struct win *w;
+
+	CALL(1, 0);
+	w = get_win(window);
+	if (w == NULL)
+		return 1;
+	configure(w,
+			mask & CWX ? changes->x : w->x,
+			mask & CWY ? changes->y : w->y,
+			mask & CWWidth ? changes->width : w->w,
+			mask & CWHeight ? changes->height : w->h);
+	return 1;
+}
+
+int XSetWindowBackground(Display *d, Window window, unsigned long pixel)
+{
+	CALL(1, 0);
+	return 1;
+}
+
+int XSetWindowBackgroundPixmap(Display *d, Window window, Pixmap pixmap)
+{
+	CALL(1, 0);
+	return 1;
+}
+
+int XClearWindow(Display *d, Window window)
+{
+	DRAW_CALL();
+	return 1;
+}
+
+int XClearArea(Display *d, Window window, int x, int y, unsigned int w, unsigned int h, Bool exposures)
+{
+	DRAW_CALL();
+	return 1;
+}
+
+Pixmap XCreatePixmap(Display *d, Drawable drawable, unsigned int w, unsigned int h, unsigned int depth)
+{
+	CALL(1, 0);
+	return next_id++;
+}
+
+int XFreePixmap(Display *d, Pixmap pixmap)
+{
+	CALL(1, 0);
+	return 1;
+}
+
+GC XCreateGC(Display *d, Drawable drawable, unsigned long mask, XGCValues *values)
+{
+	GC gc = calloc(1, sizeof(*gc));
+
+	CALL(1, 0);
+	if (values)
+		gc->values = *values;
+	return gc;
+}
+
+int XFreeGC(Display *d, GC gc)
+{
+	CALL(1, 0);
+	free(gc);
+	return 1;
+}
+
+int XDrawLine(Display *d, Drawable drawable, GC gc, int x1, int y1, int x2, int y2)
+{
+	DRAW_CALL();
+	return 1;
+}
+
+int XFillRectangle(Display *d, Drawable drawable, GC gc, int x, int y, unsigned int w, unsigned int h)
+{
+	DRAW_CALL();
+	return 1;
+}
+
+/* "rgb:rr/gg/bb" and "#rrggbb" are parsed without a request */
+static int parse_color(const char *spec, XColor *color)
+{
+	unsigned int r, g, b;
+
+	if (sscanf(spec, "rgb:%x/%x/%x", &r, &g, &b) != 3 &&
+			sscanf(spec, "#%2x%2x%2x", &r, &g, &b) != 3)
+		return 0;
+	color->red = r * 0x101;
+	color->green = g * 0x101;
+	color->blue = b * 0x101;
+	color->flags = DoRed | DoGreen | DoBlue;
+	return 1;
+}
+
+static unsigned long color_pixel(const XColor *color)
+{
+	return (color->red >> 8) << 16 | (color->green >> 8) << 8 | color->blue >> 8;
+}
+
+Status XParseColor(Display *d, Colormap cmap, _Xconst char *spec, XColor *color)
+{
+	if (parse_color(spec, color)) {
+		CALL(0, 0);
+		return 1;
+	}
+	/* LookupColor, unknown names are grey */
+	CALL(1, 1);
+	color->red = color->green = color->blue = 0x8080;
+	return 1;
+}
+
+Status XAllocColor(Display *d, Colormap cmap, XColor *color)
+{
+	CALL(1, 1);
+	color->pixel = color_pixel(color);
+	return 1;
+}
+
+int XParseGeometry(_Xconst char *str, int *x, int *y, unsigned int *w, unsigned int *h)
+{
+	int mask = 0;
+	char *end;
+
+	if (str == NULL)
+		return 0;
+	if (*str == '=')
+		str++;
+	if (*str >= '0' && *str <= '9') {
+		*w = strtoul(str, &end, 10);
+		mask |= WidthValue;
+		str = end;
+		if (*str == 'x') {
+			*h = strtoul(str + 1, &end, 10);
+			mask |= HeightValue;
+			str = end;
+		}
+	}
+	if (*str == '+' || *str == '-') {
+		if (*str == '-')
+			mask |= XNegative;
+		*x = strtol(str, &end, 10);
+		mask |= XValue;
+		str = end;
+		if (*str == '+' || *str == '-') {
+			if (*str == '-')
+				mask |= YNegative;
+			*y = strtol(str, &end, 10);
+			mask |= YValue;
+		}
+	}
+	return mask;
+}
+
+Status XGetWMNormalHints(Display *d, Window window, XSizeHints *hints, long *supplied)
+{
+	struct win *w;
+	struct prop *p;
+
+	CALL(1, 1);
+	*supplied = 0;
+	w = get_win(window);
+	if (w == NULL)
+		return 0;
+	for (p = w->props; p; p = p->next) {
+		if (p->atom == XA_WM_NORMAL_HINTS)
+			break;
+	}
+	if (p == NULL)
+		return 0;
+	memcpy(hints, p->data, sizeof(*hints));
+	*supplied = hints->flags;
+	return 1;
+}
+
+void XSetWMNormalHints(Display *d, Window window, XSizeHints *hints)
+{
+	struct win *w;
+
+	CALL(1, 0);
+	w = get_win(window);
+	if (w)
+		set_prop(w, XA_WM_NORMAL_HINTS, XA_WM_SIZE_HINTS, 8, hints, sizeof(*hints));
+}
+
+/* -- Xft, TrueColor only -- */
+
+Bool XftColorAllocName(Display *d, _Xconst Visual *v, Colormap cmap,
+		_Xconst char *name, XftColor *result)
+{
+	XColor c;
+
+	CALL(0, 0);
+	if (!parse_color(name, &c))
+		return False;
+	result->pixel = color_pixel(&c);
+	result->color.red = c.red;
+	result->color.green = c.green;
+	result->color.blue = c.blue;
+	result->color.alpha = 0xffff;
+	return True;
+}
+
+void XftColorFree(Display *d, Visual *v, Colormap cmap, XftColor *color)
+{
+	CALL(0, 0);
+}
+
+XftDraw *XftDrawCreate(Display *d, Drawable drawable, Visual *v, Colormap cmap)
+{
+	XftDraw *draw = calloc(1, sizeof(*draw));
+
+	CALL(0, 0);
+	draw->drawable = drawable;
+	draw->visual = v;
+	draw->colormap = cmap;
+	return draw;
+}
+
+void XftDrawDestroy(XftDraw *draw)
+{
+	/* FreePicture */
+	CALL(1, 0);
+	free(draw);
+}
+
+void XftDrawChange(XftDraw *draw, Drawable drawable)
+{
+	/* FreePicture, next draw creates a new one */
+	DRAW_CALL();
+	draw->drawable = drawable;
+}
+
+Visual *XftDrawVisual(XftDraw *draw)
+{
+	return draw->visual;
+}
+
+Colormap XftDrawColormap(XftDraw *draw)
+{
+	return draw->colormap;
+}
+
+Bool XftDrawSetClipRectangles(XftDraw *draw, int x, int y, _Xconst XRectangle *rects, int n)
+{
+	DRAW_CALL();
+	return True;
+}
+
+void XftDrawStringUtf8(XftDraw *draw, _Xconst XftColor *color, XftFont *font,
+		int x, int y, _Xconst FcChar8 *str, int len)
+{
+	/* CompositeGlyphs */
+	DRAW_CALL();
+}
+
+/* fixed 6x12 font */
+XftFont *XftFontOpenName(Display *d, int screen_nr, _Xconst char *name)
+{
+	XftFont *font = calloc(1, sizeof(*font));
+
+	CALL(0, 0);
+	font->ascent = 10;
+	font->descent = 2;
+	font->height = 12;
+	font->max_advance_width = 6;
+	return font;
+}
+
+void XftFontClose(Display *d, XftFont *font)
+{
+	CALL(0, 0);
+	free(font);
+}
+
+void XftTextExtentsUtf8(Display *d, XftFont *font, _Xconst FcChar8 *str, int len,
+		XGlyphInfo *extents)
+{
+	CALL(0, 0);
+	memset(extents, 0, sizeof(*extents));
+	extents->width = len * font->max_advance_width;
+	extents->height = font->height;
+	extents->y = font->ascent;
+	extents->xOff = extents->width;
+}
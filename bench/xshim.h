@@ -0,0 +1,64 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef _XSHIM_H
+#define _XSHIM_H
+
+#include <X11/Xlib.h>
+#include <stdio.h>
+
+/*
+ * Fake Xlib and Xft for tests without an X server. Link bench/xshim.o
+ * instead of -lX11 and -lXft.
+ *
+ * Windows and properties live in memory and events are queued like the
+ * server would queue them. Every call is counted and so are the protocol
+ * requests the real libraries would send. Glyph uploads and other
+ * requests Xft sends behind the scenes are not counted.
+ */
+
+struct xshim_counts {
+	/* NextRequest() moves by this */
+	unsigned long requests;
+	/* requests which wait for a reply */
+	unsigned long round_trips;
+	/* part of requests which only draw: fill, line, text, clear */
+	unsigned long draw_requests;
+	/* requests on windows which do not exist */
+	unsigned long errors;
+};
+
+extern struct xshim_counts xshim_counts;
+
+/* resets counts and per function calls */
+extern void xshim_reset_counts(void);
+/* prints functions called since xshim_reset_counts() */
+extern void xshim_print_calls(FILE *f);
+
+/*
+ * Changes made by other clients (the window manager). Not counted, but
+ * they generate events.
+ */
+extern Atom xshim_atom(const char *name);
+extern Window xshim_create_window(int x, int y, int w, int h);
+extern void xshim_destroy_window(Window window);
+extern void xshim_move_window(Window window, int x, int y, int w, int h);
+/* @data: @nr elements of @format bits. format 32 is an array of longs */
+extern void xshim_set_property(Window window, const char *name, Atom type, int format,
+		const void *data, int nr);
+
+#endif
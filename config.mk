@@ -0,0 +1,12 @@
+CC                = gcc
+LD                = gcc
+CFLAGS            = -O2 -std=gnu99 -pipe -Wall -Wshadow -Wcast-align -Wpointer-arith -Wundef -Wmissing-prototypes -Wredundant-decls -Wdeclaration-after-statement -Wold-style-definition -Wno-pointer-sign -MMD -MP -MF .dep-$@ -Werror -DDEBUG=2
+LDFLAGS           = -lXrender -lfontconfig -lfreetype -lz -lX11
+SOFLAGS           = -fPIC
+PKG_CONFIG        = /usr/bin/pkg-config
+XFT_CFLAGS        = -I/usr/include/freetype2 -I/usr/include/libpng16 
+XFT_LIBS          = -lXft 
+bindir            = /root/bin
+datadir           = /root/share
+mandir            = /root/share/man
+topdir            = /root/repo
@@ -0,0 +1,256 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include <event.h>
+#include <x.h>
+#include <xmalloc.h>
+
+#include <X11/Xlib.h>
+#include <poll.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+struct event_stats event_stats;
+
+/* index to events[], -1 (free) or -2 (closed Expose series). used to
+ * find earlier PropertyNotify / Expose event with same key without
+ * scanning the whole batch
+ */
+static int *hash = NULL;
+static unsigned int hash_size = 0;
+
+/* self-pipe, written by signal handlers */
+static int wakeup_fds[2] = { -1, -1 };
+
+int event_wakeup_init(void)
+{
+	int i;
+
+	if (wakeup_fds[0] != -1)
+		return 0;
+	if (pipe(wakeup_fds))
+		return -1;
+	for (i = 0; i < 2; i++) {
+		fcntl(wakeup_fds[i], F_SETFL, fcntl(wakeup_fds[i], F_GETFL) | O_NONBLOCK);
+		fcntl(wakeup_fds[i], F_SETFD, FD_CLOEXEC);
+	}
+	return 0;
+}
+
+void event_wakeup(void)
+{
+	int saved_errno = errno;
+
+	/* pipe full means a wakeup is pending anyway */
+	if (wakeup_fds[1] != -1 && write(wakeup_fds[1], "", 1) == -1)
+		;
+	errno = saved_errno;
+}
+
+static void wakeup_drain(void)
+{
+	char buf[64];
+
+	while (read(wakeup_fds[0], buf, sizeof(buf)) > 0)
+		;
+}
+
+void event_batch_init(struct event_batch *batch)
+{
+	batch->events = NULL;
+	batch->nr = 0;
+	batch->alloc = 0;
+}
+
+void event_batch_free(struct event_batch *batch)
+{
+	free(batch->events);
+	event_batch_init(batch);
+	free(hash);
+	hash = NULL;
+	hash_size = 0;
+}
+
+static void batch_add(struct event_batch *batch)
+{
+	if (batch->nr == batch->alloc) {
+		batch->alloc = batch->alloc ? batch->alloc * 2 : 64;
+		batch->events = xrenew(XEvent, batch->events, batch->alloc);
+	}
+	XNextEvent(display, &batch->events[batch->nr++]);
+	event_stats.read++;
+}
+
+int event_batch_read(struct event_batch *batch, int timeout)
+{
+	int blocked = 0;
+
+	batch->nr = 0;
+	while (!XPending(display)) {
+		struct pollfd pfd[2];
+		int rc;
+
+		/* XNextEvent would not return on signals. a signal which
+		 * arrives before poll() is not lost, its handler has
+		 * written to the pipe */
+		blocked = 1;
+		pfd[0].fd = ConnectionNumber(display);
+		pfd[0].events = POLLIN;
+		pfd[1].fd = wakeup_fds[0];
+		pfd[1].events = POLLIN;
+		pfd[1].revents = 0;
+		rc = poll(pfd, wakeup_fds[0] == -1 ? 1 : 2, timeout);
+		if (rc == 0 || (rc == -1 && errno == EINTR))
+			return blocked;
+		if (pfd[1].revents) {
+			wakeup_drain();
+			return blocked;
+		}
+	}
+	do {
+		batch_add(batch);
+	} while (XPending(display));
+	return blocked;
+}
+
+static unsigned int event_hash(const XEvent *e)
+{
+	unsigned long h = e->xany.window * 31 + e->type;
+
+	if (e->type == PropertyNotify)
+		h = h * 31 + e->xproperty.atom;
+	return (h ^ (h >> 7)) & (hash_size - 1);
+}
+
+static int same_key(const XEvent *a, const XEvent *b)
+{
+	if (a->type != b->type || a->xany.window != b->xany.window)
+		return 0;
+	if (a->type == PropertyNotify)
+		return a->xproperty.atom == b->xproperty.atom;
+	return 1;
+}
+
+/* returns slot of earlier event with same key or a free slot */
+static unsigned int hash_lookup(const XEvent *events, const XEvent *e)
+{
+	unsigned int h = event_hash(e);
+
+	while (hash[h] != -1) {
+		if (hash[h] >= 0 && same_key(&events[hash[h]], e))
+			break;
+		h = (h + 1) & (hash_size - 1);
+	}
+	return h;
+}
+
+static void expose_merge(XExposeEvent *dst, const XExposeEvent *src)
+{
+	int x1 = dst->x < src->x ? dst->x : src->x;
+	int y1 = dst->y < src->y ? dst->y : src->y;
+	int x2 = dst->x + dst->width;
+	int y2 = dst->y + dst->height;
+
+	if (src->x + src->width > x2)
+		x2 = src->x + src->width;
+	if (src->y + src->height > y2)
+		y2 = src->y + src->height;
+	dst->x = x1;
+	dst->y = y1;
+	dst->width = x2 - x1;
+	dst->height = y2 - y1;
+	/* repaint when the kept event is dispatched */
+	dst->count = 0;
+}
+
+void event_batch_compress(struct event_batch *batch)
+{
+	XEvent *events = batch->events;
+	unsigned int h;
+	int i, j, k, dropped = 0;
+
+	if (batch->nr < 2)
+		return;
+
+	if (hash_size < 2 * (unsigned int)batch->nr) {
+		while (hash_size < 2 * (unsigned int)batch->nr)
+			hash_size = hash_size ? hash_size * 2 : 128;
+		hash = xrenew(int, hash, hash_size);
+	}
+	for (h = 0; h < hash_size; h++)
+		hash[h] = -1;
+
+	j = 0;
+	for (i = 0; i < batch->nr; i++) {
+		XEvent *e = &events[i];
+
+		switch (e->type) {
+		case MotionNotify:
+			if (j > 0 && events[j - 1].type == MotionNotify &&
+					events[j - 1].xany.window == e->xany.window) {
+				events[j - 1] = *e;
+				event_stats.motion_collapsed++;
+				continue;
+			}
+			break;
+		case PropertyNotify:
+			/* keep the last one at its own position, events
+			 * between them must not be reordered */
+			h = hash_lookup(events, e);
+			if (hash[h] != -1) {
+				events[hash[h]].type = 0;
+				event_stats.property_collapsed++;
+				dropped++;
+			}
+			hash[h] = j;
+			break;
+		case Expose:
+			h = hash_lookup(events, e);
+			k = hash[h];
+			if (k != -1) {
+				expose_merge(&events[k].xexpose, &e->xexpose);
+				event_stats.expose_collapsed++;
+				/* count 0 ends the series, next Expose
+				 * starts a new one */
+				if (e->xexpose.count == 0)
+					hash[h] = -2;
+				continue;
+			}
+			if (e->xexpose.count)
+				hash[h] = j;
+			break;
+		}
+		if (j != i)
+			events[j] = *e;
+		j++;
+	}
+	batch->nr = j;
+
+	/* remove replaced PropertyNotify events */
+	if (dropped) {
+		j = 0;
+		for (i = 0; i < batch->nr; i++) {
+			if (events[i].type == 0)
+				continue;
+			if (j != i)
+				events[j] = events[i];
+			j++;
+		}
+		batch->nr = j;
+	}
+}
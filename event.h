@@ -0,0 +1,71 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef _EVENT_H
+#define _EVENT_H
+
+#include <X11/Xlib.h>
+
+/* events read from the X connection in one go */
+struct event_batch {
+	XEvent *events;
+	int nr;
+	int alloc;
+};
+
+/* number of events dropped by event_batch_compress() */
+struct event_stats {
+	unsigned long read;
+	unsigned long motion_collapsed;
+	unsigned long property_collapsed;
+	unsigned long expose_collapsed;
+};
+
+extern struct event_stats event_stats;
+
+extern void event_batch_init(struct event_batch *batch);
+extern void event_batch_free(struct event_batch *batch);
+
+/* blocks until at least one event is available, then reads every
+ * event that is already queued. returns 1 if it had to block.
+ * batch is empty if a signal interrupted the wait or @timeout ms
+ * passed (-1 = no timeout) */
+extern int event_batch_read(struct event_batch *batch, int timeout);
+
+/* creates the pipe event_wakeup() writes to. returns -1 on error */
+extern int event_wakeup_init(void);
+/* async-signal-safe. makes event_batch_read() return even if the signal
+ * arrived just before it started to wait */
+extern void event_wakeup(void);
+
+/* ButtonPress, ButtonRelease, MotionNotify, EnterNotify or LeaveNotify */
+static inline int event_is_input(const XEvent *e)
+{
+	return e->type >= ButtonPress && e->type <= LeaveNotify;
+}
+
+/*
+ * - consecutive MotionNotify events of same window => the last one
+ * - PropertyNotify events with same window and atom => the last one,
+ *   at its own position
+ * - series of Expose events of same window => the first one with
+ *   count = 0 which covers bounding box of the whole series. a series
+ *   ends with count = 0, the next Expose starts a new one
+ */
+extern void event_batch_compress(struct event_batch *batch);
+
+#endif
@@ -0,0 +1,106 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include <geom.h>
+#include <xmalloc.h>
+
+void geom_init(struct geom *g)
+{
+	g->root_w = 1;
+	g->root_h = 1;
+	g->desk_w = 1;
+	g->desk_h = 1;
+	g->sx = g->sy = g->rsx = g->rsy = 1ULL << 32;
+	g->x_map = NULL;
+	g->y_map = NULL;
+	g->map_w = 0;
+	g->map_h = 0;
+}
+
+void geom_free(struct geom *g)
+{
+	free(g->x_map);
+	free(g->y_map);
+	geom_init(g);
+}
+
+/* num / den rounded up */
+static unsigned long long fixed_div(int num, int den)
+{
+	return (((unsigned long long)num << 32) + den - 1) / den;
+}
+
+/* slow path of geom_from_pager(), @v may be outside of the pager */
+static void map_coord(int v, int desk_size, unsigned long long rs, struct geom_map *m)
+{
+	m->cell = v / (desk_size + 1);
+	m->local = v - m->cell * (desk_size + 1);
+	m->root = geom_scale(m->local, rs);
+}
+
+static struct geom_map *fill_map(struct geom_map *map, int *map_size, int size,
+		int desk_size, unsigned long long rs)
+{
+	int i;
+
+	if (*map_size != size) {
+		map = xrenew(struct geom_map, map, size);
+		*map_size = size;
+	}
+	for (i = 0; i < size; i++)
+		map_coord(i, desk_size, rs, &map[i]);
+	return map;
+}
+
+void geom_configure(struct geom *g, int w, int h, int desk_w, int desk_h, int root_w, int root_h)
+{
+	g->root_w = root_w > 0 ? root_w : 1;
+	g->root_h = root_h > 0 ? root_h : 1;
+	g->desk_w = desk_w > 0 ? desk_w : 1;
+	g->desk_h = desk_h > 0 ? desk_h : 1;
+
+	g->sx = fixed_div(g->desk_w, g->root_w);
+	g->sy = fixed_div(g->desk_h, g->root_h);
+	g->rsx = fixed_div(g->root_w, g->desk_w);
+	g->rsy = fixed_div(g->root_h, g->desk_h);
+
+	g->x_map = fill_map(g->x_map, &g->map_w, w > 0 ? w : 0, g->desk_w, g->rsx);
+	g->y_map = fill_map(g->y_map, &g->map_h, h > 0 ? h : 0, g->desk_h, g->rsy);
+}
+
+void geom_from_pager(const struct geom *g, int x, int y, struct geom_point *p)
+{
+	struct geom_map mx, my;
+
+	if (x >= 0 && x < g->map_w) {
+		mx = g->x_map[x];
+	} else {
+		/* pointer grabbed and outside of the pager */
+		map_coord(x, g->desk_w, g->rsx, &mx);
+	}
+	if (y >= 0 && y < g->map_h) {
+		my = g->y_map[y];
+	} else {
+		map_coord(y, g->desk_h, g->rsy, &my);
+	}
+	p->col = mx.cell;
+	p->row = my.cell;
+	p->lx = mx.local;
+	p->ly = my.local;
+	p->rx = mx.root;
+	p->ry = my.root;
+}
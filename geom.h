@@ -0,0 +1,99 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef _GEOM_H
+#define _GEOM_H
+
+/*
+ * Root window <=> pager coordinate mapping.
+ *
+ * Scale factors are 32.32 fixed point rounded up, which gives exactly
+ * the same result as v * desk_w / root_w (truncated towards zero) for
+ * all 16 bit coordinates. Drawing and hit-testing both use these so they
+ * always agree.
+ */
+
+/* pager window coordinate => desktop column / row, coordinate relative
+ * to the desktop cell and root window coordinate */
+struct geom_map {
+	int cell;
+	int local;
+	int root;
+};
+
+struct geom {
+	int root_w, root_h;
+	int desk_w, desk_h;
+
+	/* root => pager */
+	unsigned long long sx, sy;
+	/* pager => root */
+	unsigned long long rsx, rsy;
+
+	/* precalculated geom_from_pager() for every pixel of the pager */
+	struct geom_map *x_map;
+	struct geom_map *y_map;
+	int map_w, map_h;
+};
+
+struct geom_point {
+	int col, row;
+	/* relative to the desktop cell */
+	int lx, ly;
+	/* root window coordinates */
+	int rx, ry;
+};
+
+extern void geom_init(struct geom *g);
+extern void geom_free(struct geom *g);
+
+/* @w, @h: pager window size */
+extern void geom_configure(struct geom *g, int w, int h, int desk_w, int desk_h, int root_w, int root_h);
+
+static inline int geom_scale(int v, unsigned long long m)
+{
+	if (v < 0)
+		return -(int)(((unsigned long long)-v * m) >> 32);
+	return ((unsigned long long)v * m) >> 32;
+}
+
+/* root window coordinate or size => pager */
+static inline int geom_to_pager_x(const struct geom *g, int v)
+{
+	return geom_scale(v, g->sx);
+}
+
+static inline int geom_to_pager_y(const struct geom *g, int v)
+{
+	return geom_scale(v, g->sy);
+}
+
+/* coordinate relative to a desktop cell => root window */
+static inline int geom_to_root_x(const struct geom *g, int v)
+{
+	return geom_scale(v, g->rsx);
+}
+
+static inline int geom_to_root_y(const struct geom *g, int v)
+{
+	return geom_scale(v, g->rsy);
+}
+
+/* @x, @y: relative to the pager window, may be outside of it */
+extern void geom_from_pager(const struct geom *g, int x, int y, struct geom_point *p);
+
+#endif
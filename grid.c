@@ -0,0 +1,110 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include <grid.h>
+#include <xmalloc.h>
+
+void grid_init(struct grid *grid)
+{
+	int i;
+
+	grid->w = 1;
+	grid->h = 1;
+	for (i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+		grid->cells[i].rects = NULL;
+		grid->cells[i].nr = 0;
+		grid->cells[i].alloc = 0;
+	}
+	grid->dirty = 1;
+}
+
+void grid_free(struct grid *grid)
+{
+	int i;
+
+	for (i = 0; i < GRID_SIZE * GRID_SIZE; i++) {
+		mem_free(MEM_CLIENTS, grid->cells[i].rects);
+	}
+	grid_init(grid);
+}
+
+void grid_clear(struct grid *grid, int w, int h)
+{
+	int i;
+
+	grid->w = w > 0 ? w : 1;
+	grid->h = h > 0 ? h : 1;
+	for (i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+		grid->cells[i].nr = 0;
+	grid->dirty = 0;
+}
+
+/* coordinate => cell column or row, clamped to the grid */
+static inline int to_cell(int pos, int size)
+{
+	if (pos < 0)
+		return 0;
+	if (pos >= size)
+		return GRID_SIZE - 1;
+	return pos * GRID_SIZE / size;
+}
+
+void grid_add(struct grid *grid, int idx, int x, int y, int w, int h)
+{
+	int col1, col2, row1, row2, col, row;
+
+	if (w <= 0 || h <= 0)
+		return;
+
+	col1 = to_cell(x, grid->w);
+	col2 = to_cell(x + w - 1, grid->w);
+	row1 = to_cell(y, grid->h);
+	row2 = to_cell(y + h - 1, grid->h);
+	for (row = row1; row <= row2; row++) {
+		for (col = col1; col <= col2; col++) {
+			struct grid_cell *cell = &grid->cells[row * GRID_SIZE + col];
+			struct grid_rect *r;
+
+			if (cell->nr == cell->alloc) {
+				cell->alloc = cell->alloc ? cell->alloc * 2 : 8;
+				cell->rects = mem_renew(MEM_CLIENTS, struct grid_rect, cell->rects, cell->alloc);
+			}
+			r = &cell->rects[cell->nr++];
+			r->idx = idx;
+			r->x = x;
+			r->y = y;
+			r->w = w;
+			r->h = h;
+		}
+	}
+}
+
+int grid_lookup(const struct grid *grid, int x, int y)
+{
+	const struct grid_cell *cell;
+	int i;
+
+	/* rectangles outside of the area are in the border cells */
+	cell = &grid->cells[to_cell(y, grid->h) * GRID_SIZE + to_cell(x, grid->w)];
+	for (i = cell->nr - 1; i >= 0; i--) {
+		const struct grid_rect *r = &cell->rects[i];
+
+		if (x >= r->x && x < r->x + r->w && y >= r->y && y < r->y + r->h)
+			return r->idx;
+	}
+	return -1;
+}
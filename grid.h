@@ -0,0 +1,64 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef _GRID_H
+#define _GRID_H
+
+/*
+ * Uniform grid of rectangles for hit-testing.
+ *
+ * Every rectangle is stored in each cell it overlaps. Parts outside of
+ * the area belong to the nearest border cell. Rectangles must be
+ * added in stacking order (bottom first) so grid_lookup() can return the
+ * first match when walking a cell from the end.
+ */
+
+#define GRID_SIZE	16
+
+struct grid_rect {
+	/* caller's index, usually index to windows[] */
+	int idx;
+	int x, y, w, h;
+};
+
+struct grid_cell {
+	struct grid_rect *rects;
+	int nr;
+	int alloc;
+};
+
+struct grid {
+	/* size of the area: one desktop cell, in pager coordinates */
+	int w, h;
+	struct grid_cell cells[GRID_SIZE * GRID_SIZE];
+
+	/* needs to be rebuilt before next lookup */
+	unsigned int dirty : 1;
+};
+
+extern void grid_init(struct grid *grid);
+extern void grid_free(struct grid *grid);
+
+/* remove all rectangles, keeps allocated memory */
+extern void grid_clear(struct grid *grid, int w, int h);
+
+extern void grid_add(struct grid *grid, int idx, int x, int y, int w, int h);
+
+/* returns idx of topmost rectangle containing (@x, @y) or -1 */
+extern int grid_lookup(const struct grid *grid, int x, int y);
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include <hist.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+void hist_add(struct hist *h, unsigned long long us)
+{
+	unsigned int v = us > ~0U ? ~0U : us;
+
+	h->samples[h->count % HIST_SAMPLES] = v;
+	h->count++;
+	h->sum += v;
+	if (v > h->max)
+		h->max = v;
+}
+
+static int uint_cmp(const void *a, const void *b)
+{
+	unsigned int x = *(const unsigned int *)a;
+	unsigned int y = *(const unsigned int *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+unsigned int hist_percentile(const struct hist *h, int pct)
+{
+	unsigned int sorted[HIST_SAMPLES];
+	int n = h->count < HIST_SAMPLES ? h->count : HIST_SAMPLES;
+	int i;
+
+	if (n == 0)
+		return 0;
+	memcpy(sorted, h->samples, n * sizeof(unsigned int));
+	qsort(sorted, n, sizeof(unsigned int), uint_cmp);
+	i = (n * pct + 99) / 100 - 1;
+	if (i < 0)
+		i = 0;
+	return sorted[i];
+}
+
+void hist_print(FILE *f, const struct hist *h)
+{
+	fprintf(f, "%s: n=%lu avg=%llu p50=%u p99=%u max=%u us\n",
+			h->name, h->count,
+			h->count ? h->sum / h->count : 0,
+			hist_percentile(h, 50),
+			hist_percentile(h, 99),
+			h->max);
+}
@@ -0,0 +1,53 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef _HIST_H
+#define _HIST_H
+
+#include <stdio.h>
+#include <time.h>
+
+/* latest HIST_SAMPLES samples are kept for percentiles */
+#define HIST_SAMPLES	4096
+
+/* latency histogram, values are in microseconds */
+struct hist {
+	const char *name;
+	unsigned long count;
+	unsigned long long sum;
+	unsigned int max;
+	unsigned int samples[HIST_SAMPLES];
+};
+
+#define HIST_INIT(name) { name, 0, 0, 0, { 0, } }
+
+static inline unsigned long long time_us(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+extern void hist_add(struct hist *h, unsigned long long us);
+
+/* @pct: 0-100 */
+extern unsigned int hist_percentile(const struct hist *h, int pct);
+
+extern void hist_print(FILE *f, const struct hist *h);
+
+#endif
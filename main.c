@@ -22,19 +22,40 @@
 #include <opt.h>
 #include <x.h>
 #include <sconf.h>
+#include <event.h>
+#include <hist.h>
+#include <stats.h>
+#include <trace.h>
+#include <replay.h>
+#include <profile.h>
+#include <debug.h>
 
 #include <X11/Xlib.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <errno.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <dirent.h>
+#include <signal.h>
 
 char *program_name = NULL;
 
 static struct pager *pager;
-static int running = 1;
+/* cleared by SIGTERM and SIGINT */
+static volatile sig_atomic_t running = 1;
+
+/* -profile-startup, cleared when the profile has been printed */
+static int profile_startup = 0;
+
+static void check_profile(void)
+{
+	if (profile_startup && profile_done()) {
+		profile_print(stderr);
+		profile_startup = 0;
+	}
+}
 
 static void ignored(XEvent *event)
 {
@@ -42,14 +63,16 @@ static void ignored(XEvent *event)
 }
 
 /*
- * SubstructureNotifyMask:
+ * StructureNotifyMask (pager window and clients):
  *
- * CirculateNotify, ConfigureNotify, CreateNotify, DestroyNotify,
- * GravityNotify, MapNotify, ReparentNotify, UnmapNotify
+ * CirculateNotify, ConfigureNotify, DestroyNotify, GravityNotify,
+ * MapNotify, ReparentNotify, UnmapNotify
  */
 static void handle_event(XEvent *event)
 {
 /* 	printf("event %2d, window 0x%x\n", event->type, (int)event->xany.window); */
+	trace_begin("handle_event", "\"type\":%d,\"window\":%lu",
+			event->type, (unsigned long)event->xany.window);
 	switch (event->type) {
 	case ButtonPress:
 		pager_button_press(pager, event->xbutton.x, event->xbutton.y, event->xbutton.button);
@@ -58,10 +81,12 @@ static void handle_event(XEvent *event)
 		pager_button_release(pager, event->xbutton.x, event->xbutton.y, event->xbutton.button);
 		break;
 	case MotionNotify:
-		pager_motion(pager, event->xbutton.x, event->xbutton.y);
+		pager_motion(pager, event->xmotion.x, event->xmotion.y,
+				event->xmotion.x_root, event->xmotion.y_root);
 		break;
 	case EnterNotify:
-		pager_enter(pager, event->xcrossing.x, event->xcrossing.y);
+		pager_enter(pager, event->xcrossing.x, event->xcrossing.y,
+				event->xcrossing.x_root, event->xcrossing.y_root);
 		break;
 	case LeaveNotify:
 		pager_leave(pager);
@@ -85,13 +110,16 @@ static void handle_event(XEvent *event)
 		ignored(event);
 		break;
 	case ConfigureNotify:
-		pager_configure_notify(pager);
+		pager_configure_notify(pager, &event->xconfigure);
 		break;
 	case CirculateNotify:
 		ignored(event);
 		break;
+	case GravityNotify:
+		ignored(event);
+		break;
 	case PropertyNotify:
-		pager_property_notify(pager);
+		pager_property_notify(pager, &event->xproperty);
 		break;
 	case ClientMessage:
 		ignored(event);
@@ -99,19 +127,191 @@ static void handle_event(XEvent *event)
 	default:
 		printf("unexpected event %2d, window 0x%x\n", event->type, (int)event->xany.window);
 	}
+	trace_end("handle_event");
+}
+
+#if DEBUG > 0
+/* set by SIGUSR1 and SIGUSR2 */
+static volatile sig_atomic_t dump_stats = 0;
+static volatile sig_atomic_t reset_stats = 0;
+
+/* $NETWMPAGER_STATS or NULL for stderr */
+static const char *stats_file = NULL;
+
+/* queue was empty at this time before the last batch, 0 if painted */
+static unsigned long long batch_time = 0;
+static unsigned long nr_paints = 0;
+
+static void sigusr_handler(int sig)
+{
+	if (sig == SIGUSR1)
+		dump_stats = 1;
+	else
+		reset_stats = 1;
+	event_wakeup();
+}
+
+static void stats_init(void)
+{
+	struct sigaction act;
+
+	stats_file = getenv("NETWMPAGER_STATS");
+
+	/* no SA_RESTART, event_batch_read must return */
+	act.sa_handler = sigusr_handler;
+	sigemptyset(&act.sa_mask);
+	act.sa_flags = 0;
+	sigaction(SIGUSR1, &act, NULL);
+	sigaction(SIGUSR2, &act, NULL);
+}
+
+/* adds sample to event_to_paint if something was painted */
+static void check_paint(void)
+{
+	unsigned long n = stats.full_repaints + stats.partial_repaints + stats.popup_repaints;
+
+	if (n != nr_paints && batch_time) {
+		hist_add(&event_to_paint, time_us() - batch_time);
+		batch_time = 0;
+	}
+	nr_paints = n;
+}
+#endif
+
+static void sigterm_handler(int sig)
+{
+	running = 0;
+	event_wakeup();
+}
+
+/* loop() returns so that stats and trace are written at exit */
+static void signals_init(void)
+{
+	struct sigaction act;
+
+	if (event_wakeup_init())
+		fprintf(stderr, "%s: pipe: %s\n", program_name, strerror(errno));
+	/* no SA_RESTART, event_batch_read must return */
+	act.sa_handler = sigterm_handler;
+	sigemptyset(&act.sa_mask);
+	act.sa_flags = 0;
+	sigaction(SIGTERM, &act, NULL);
+	sigaction(SIGINT, &act, NULL);
 }
 
+/* input events are handled before anything else in the batch.
+ * @since: events arrived after this time
+ */
+static void dispatch(struct event_batch *batch, unsigned long long since)
+{
+	int i;
+
+	for (i = 0; i < batch->nr; i++) {
+		XEvent *e = &batch->events[i];
+
+		if (e->type < LASTEvent)
+			STAT_INC(events[e->type]);
+		if (!event_is_input(e))
+			continue;
+		handle_event(e);
+		if (e->type == ButtonPress || e->type == ButtonRelease)
+			STAT_HIST(click_latency, time_us() - since);
+	}
+	for (i = 0; i < batch->nr; i++) {
+		if (!event_is_input(&batch->events[i]))
+			handle_event(&batch->events[i]);
+	}
+}
+
+/*
+ * pager_handle_events() does a bounded slice of work (fetching properties
+ * of some clients, drawing). Pending events are read between the slices
+ * so input is never stuck behind a full refresh.
+ */
 static void loop(void)
 {
+	struct event_batch batch;
+	unsigned long long empty = time_us();
+	int busy;
+
+	event_batch_init(&batch);
+	signals_init();
 	while (running) {
-		pager_handle_events(pager);
-		do {
+		busy = pager_needs_work(pager) && pager_handle_events(pager);
+		check_profile();
+#if DEBUG > 0
+		check_paint();
+		if (dump_stats) {
+			dump_stats = 0;
+			stats_dump(stats_file);
+		}
+		if (reset_stats) {
+			reset_stats = 0;
+			stats_reset();
+			batch_time = 0;
+		}
+#endif
+		if (!XPending(display)) {
+			empty = time_us();
+			if (busy)
+				continue;
+		}
+		if (event_batch_read(&batch, pager_timeout(pager)))
+			empty = time_us();
+		if (replay_mode == REPLAY_RECORD && batch.nr)
+			replay_record_batch(batch.events, batch.nr);
+		event_batch_compress(&batch);
+		dispatch(&batch, empty);
+#if DEBUG > 0
+		if (batch.nr)
+			batch_time = empty;
+		check_paint();
+#endif
+	}
+	event_batch_free(&batch);
+
+	d_print("events: %lu read, %lu motion, %lu property, %lu expose collapsed\n",
+			event_stats.read,
+			event_stats.motion_collapsed,
+			event_stats.property_collapsed,
+			event_stats.expose_collapsed);
+	x_print_echo_stats();
+#if DEBUG > 0
+	stats_dump(stats_file);
+#endif
+}
+
+/*
+ * Recorded batches are replayed as fast as possible. All work caused by
+ * a batch is finished before the next one so the result does not depend
+ * on timing.
+ */
+static void replay_loop(void)
+{
+	struct event_batch batch;
+
+	event_batch_init(&batch);
+	while (1) {
+		while (pager_needs_work(pager) && pager_handle_events(pager))
+			;
+		check_profile();
+		/* events from this server are not part of the recording */
+		while (XPending(display)) {
 			XEvent e;
 
 			XNextEvent(display, &e);
-			handle_event(&e);
-		} while (XPending(display));
+		}
+		if (replay_read_batch(&batch))
+			break;
+		event_batch_compress(&batch);
+		dispatch(&batch, time_us());
 	}
+	event_batch_free(&batch);
+
+	replay_print_summary();
+#if DEBUG > 0
+	stats_dump(stats_file);
+#endif
 }
 
 int ignore_bad_window = 0;
@@ -142,6 +342,9 @@ static int xerror_handler(Display *d, XErrorEvent *e)
 enum {
 	OPT_DISPLAY,
 	OPT_HELP,
+	OPT_PROFILE_STARTUP,
+	OPT_RECORD,
+	OPT_REPLAY,
 	OPT_VERSION,
 	NUM_OPTIONS
 };
@@ -149,12 +352,17 @@ enum {
 static struct option options[NUM_OPTIONS + 1] = {
 	{ "display",     1 },
 	{ "help",        0 },
+	{ "profile-startup", 0 },
+	{ "record",      1 },
+	{ "replay",      1 },
 	{ "version",     0 },
 	{ NULL,          0 }
 };
 
 /* -- configuration -- */
 static const char *display_name = NULL;
+static const char *record_file = NULL;
+static const char *replay_file = NULL;
 static char *window_font = NULL;
 static char *popup_font = NULL;
 static char *geometry = NULL;
@@ -166,6 +374,8 @@ static int allow_cover = 1;
 static int show_icons = 1;
 static int cols = -1;
 static int rows = -1;
+static int wm_wait = 15;
+static char *trace_file = NULL;
 static enum pager_layer layer = LAYER_NORMAL;
 
 static int option_handler(int opt, const char *arg)
@@ -174,12 +384,24 @@ static int option_handler(int opt, const char *arg)
 	case OPT_DISPLAY:
 		display_name = arg;
 		break;
+	case OPT_PROFILE_STARTUP:
+		profile_startup = 1;
+		break;
+	case OPT_RECORD:
+		record_file = arg;
+		break;
+	case OPT_REPLAY:
+		replay_file = arg;
+		break;
 	case OPT_HELP:
 		printf(
 "Usage: %s [OPTION]...\n"
 "\n"
 "  -display NAME      X server to connect to\n"
 "  -help              display this help and exit\n"
+"  -profile-startup   print time spent in each startup phase\n"
+"  -record FILE       record events and X replies to FILE\n"
+"  -replay FILE       replay FILE without a window manager and exit\n"
 "  -version           output version information and exit\n"
 "\n"
 "Fonts:\n"
@@ -216,11 +438,16 @@ static void load_config(void)
 		fprintf(stderr, "%s: rows must be positive integer or -1\n", program_name);
 		rows = 1;
 	}
+	if (sconf_get_int_option("wm_wait", &wm_wait) && wm_wait < 0) {
+		fprintf(stderr, "%s: wm_wait must be non-negative integer\n", program_name);
+		wm_wait = 15;
+	}
 	if (sconf_get_flt_option("opacity", &opacity) && (opacity < 0.0 || opacity > 1.0)) {
 		fprintf(stderr, "%s: opacity must be between 0.0 and 1.0\n", program_name);
 		opacity = 1.0;
 	}
 	sconf_get_str_option("geometry", &geometry);
+	sconf_get_str_option("trace_file", &trace_file);
 	sconf_get_str_option("popup_font", &popup_font);
 	sconf_get_str_option("window_font", &window_font);
 	sconf_get_bool_option("show_popups", &show_popups);
@@ -239,7 +466,7 @@ static void load_config(void)
 		} else {
 			fprintf(stderr, "%s: layer must be \"below\", \"normal\" or \"above\"\n", program_name);
 		}
-		free(str);
+		mem_free(MEM_CONFIG, str);
 	}
 
 	sconf_get_str_option("active_win_color", &active_win_color);
@@ -264,29 +491,58 @@ int main(int argc, char *argv[])
 	int nr_args = argc - 1;
 
 	program_name = argv[0];
+	profile_start();
+	profile_begin(PROFILE_CONFIG);
 	load_config();
+	profile_end(PROFILE_CONFIG);
 	nr_args -= options_parse(&args, options, option_handler, NULL);
 	if (*args) {
 		fprintf(stderr, "%s: too many arguments\n", argv[0]);
 		fprintf(stderr, "Try `%s -help' for more information.\n", argv[0]);
 		return 1;
 	}
+	if (record_file && replay_file) {
+		fprintf(stderr, "%s: -record and -replay are mutually exclusive\n", argv[0]);
+		return 1;
+	}
 
+	profile_begin(PROFILE_X_INIT);
 	if (x_init(display_name)) {
 		fprintf(stderr, "%s: unable to open display %s\n", argv[0],
 				display_name ? display_name : "");
 		return 1;
 	}
+	profile_end(PROFILE_X_INIT);
 	XSetErrorHandler(xerror_handler);
 
-	pager = pager_new(geometry, cols, rows);
-	if (pager == NULL) {
+	if (record_file && replay_record_open(record_file)) {
+		fprintf(stderr, "%s: could not open '%s'\n", argv[0], record_file);
+		x_exit();
+		return 1;
+	}
+	if (replay_file && replay_play_open(replay_file)) {
+		fprintf(stderr, "%s: could not read recording '%s'\n", argv[0], replay_file);
 		x_exit();
 		return 1;
 	}
 
-	/* window title must be set before this! */
-	XSynchronize(display, True);
+	if (getenv("NETWMPAGER_TRACE"))
+		trace_file = getenv("NETWMPAGER_TRACE");
+	if (trace_file && trace_open(trace_file))
+		fprintf(stderr, "%s: could not open trace file '%s'\n", argv[0], trace_file);
+
+#if DEBUG > 0
+	/* before the window is mapped, bench/fakewm signals the pager as
+	 * soon as it sees the window */
+	stats_init();
+#endif
+	pager = pager_new(geometry, cols, rows, wm_wait);
+	if (pager == NULL) {
+		trace_close();
+		replay_close();
+		x_exit();
+		return 1;
+	}
 
 	pager_set_layer(pager, layer);
 	pager_set_show_sticky(pager, show_sticky);
@@ -305,12 +561,19 @@ int main(int argc, char *argv[])
 					argv[0], window_font);
 	}
 
+	profile_begin(PROFILE_SHOW);
 	pager_show(pager);
+	profile_end(PROFILE_SHOW);
 	pager_set_opacity(pager, opacity);
 
-	loop();
+	if (replay_mode == REPLAY_PLAY)
+		replay_loop();
+	else
+		loop();
 
 	pager_delete(pager);
+	trace_close();
+	replay_close();
 	x_exit();
 	return 0;
 }
@@ -0,0 +1,842 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include <model.h>
+#include <xmalloc.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+#define TITLE_HPAD	3
+#define TITLE_VPAD	1
+
+/* minimum draw size of window. makes moving small windows possible
+ * these must be >= 2 (window borders take 2 pixels)
+ */
+#define WINDOW_MIN_W	3
+#define WINDOW_MIN_H	3
+
+#define WINDOW_SHADED_H	12
+
+#define DRAG_THRESHOLD	2
+
+/* ---------------------------------------------------------------------------
+ * PRIVATE
+ */
+
+static void desk_add(struct model_desk *d, int idx)
+{
+	int i;
+
+	if (d->nr_windows == d->alloc) {
+		d->alloc = d->alloc ? d->alloc * 2 : 8;
+		d->windows = mem_renew(MEM_CLIENTS, int, d->windows, d->alloc);
+	}
+	/* keep stacking order */
+	for (i = d->nr_windows; i > 0 && d->windows[i - 1] > idx; i--)
+		d->windows[i] = d->windows[i - 1];
+	d->windows[i] = idx;
+	d->nr_windows++;
+	d->grid.dirty = 1;
+}
+
+static void desk_remove(struct model_desk *d, int idx)
+{
+	int i;
+
+	for (i = 0; i < d->nr_windows; i++) {
+		if (d->windows[i] == idx) {
+			d->nr_windows--;
+			memmove(d->windows + i, d->windows + i + 1, (d->nr_windows - i) * sizeof(int));
+			d->grid.dirty = 1;
+			return;
+		}
+	}
+}
+
+static void desk_free(struct model_desk *d)
+{
+	mem_free(MEM_CLIENTS, d->windows);
+	grid_free(&d->grid);
+}
+
+/* @desk: -1 = sticky. returns NULL if @desk is out of range */
+static struct model_desk *get_desk(struct model *m, int desk)
+{
+	if (desk < -1 || desk + 1 >= m->nr_desks)
+		return NULL;
+	return &m->desks[desk + 1];
+}
+
+static void invalidate_grid(struct model *m, int desk)
+{
+	struct model_desk *d = get_desk(m, desk);
+
+	if (d)
+		d->grid.dirty = 1;
+}
+
+/* move clients[@idx] to other desktop */
+static void move_to_desk(struct model *m, int idx, int desk)
+{
+	struct model_client *c = &m->clients[idx];
+	struct model_desk *d;
+
+	d = get_desk(m, c->desk);
+	if (d)
+		desk_remove(d, idx);
+	d = get_desk(m, desk);
+	if (d)
+		desk_add(d, idx);
+	c->desk = desk;
+}
+
+/* sets windows[@pos] of @d, marks the grid dirty if it was different */
+static void desk_set(struct model_desk *d, int pos, int idx)
+{
+	if (pos < d->nr_windows && d->windows[pos] == idx)
+		return;
+	if (pos == d->alloc) {
+		d->alloc = d->alloc ? d->alloc * 2 : 8;
+		d->windows = mem_renew(MEM_CLIENTS, int, d->windows, d->alloc);
+	}
+	d->windows[pos] = idx;
+	d->grid.dirty = 1;
+}
+
+/* rebuild desks[] from clients[]. grids of desktops whose clients did
+ * not change stay valid */
+static void update_desks(struct model *m)
+{
+	int nr = m->cols * m->rows + 1;
+	int *pos;
+	int i;
+
+	for (i = nr; i < m->nr_desks; i++)
+		desk_free(&m->desks[i]);
+	if (nr != m->nr_desks) {
+		m->desks = mem_renew(MEM_CLIENTS, struct model_desk, m->desks, nr);
+		for (i = m->nr_desks; i < nr; i++) {
+			m->desks[i].windows = NULL;
+			m->desks[i].alloc = 0;
+			grid_init(&m->desks[i].grid);
+		}
+		m->nr_desks = nr;
+	}
+	/* windows[] is rewritten in place, position of the next client
+	 * in each desk */
+	pos = xnew0(int, nr);
+	for (i = 0; i < m->nr_clients; i++) {
+		int desk = m->clients[i].desk;
+
+		if (m->clients[i].pending || !get_desk(m, desk))
+			continue;
+		desk_set(&m->desks[desk + 1], pos[desk + 1]++, i);
+	}
+	for (i = 0; i < nr; i++) {
+		if (m->desks[i].nr_windows != pos[i])
+			m->desks[i].grid.dirty = 1;
+		m->desks[i].nr_windows = pos[i];
+	}
+	free(pos);
+}
+
+static void update_rect(struct model *m, struct model_client *c)
+{
+	const struct geom *g = &m->geom;
+
+	c->px = geom_to_pager_x(g, c->x);
+	c->py = geom_to_pager_y(g, c->y);
+	c->pw = geom_to_pager_x(g, c->w);
+	if (c->states & WINDOW_STATE_SHADED) {
+		c->ph = geom_to_pager_y(g, WINDOW_SHADED_H);
+	} else {
+		c->ph = geom_to_pager_y(g, c->h);
+	}
+
+	if (c->pw < WINDOW_MIN_W)
+		c->pw = WINDOW_MIN_W;
+	if (c->ph < WINDOW_MIN_H)
+		c->ph = WINDOW_MIN_H;
+}
+
+/* index of fetched client @window or -1 */
+static int find_fetched(const struct model *m, unsigned long window)
+{
+	int idx;
+
+	if (window == 0)
+		return -1;
+	idx = model_find(m, window);
+	if (idx != -1 && m->clients[idx].pending)
+		return -1;
+	return idx;
+}
+
+/* desktop of the active window, -1 for sticky, -2 if not known */
+static int active_win_desk(struct model *m)
+{
+	int idx = model_find(m, m->active_win);
+
+	return idx == -1 ? -2 : m->clients[idx].desk;
+}
+
+/*
+ * Repaint single desktop cell instead of the whole pager.
+ * @desk: -1 = all desktops (sticky window)
+ */
+static void damage_desk(struct model *m, int desk)
+{
+	int i;
+
+	/* whole pager is repainted soon anyway */
+	if (m->painted_gen != m->gen)
+		return;
+	if (desk == -1) {
+		for (desk = 0; desk < m->cols * m->rows; desk++)
+			damage_desk(m, desk);
+		return;
+	}
+	if (desk < 0 || desk >= m->cols * m->rows)
+		return;
+
+	for (i = 0; i < m->nr_damage; i++) {
+		if (m->damage[i] == desk)
+			return;
+	}
+	if (m->nr_damage == m->alloc_damage) {
+		m->alloc_damage = m->alloc_damage ? m->alloc_damage * 2 : 8;
+		m->damage = xrenew(int, m->damage, m->alloc_damage);
+	}
+	m->damage[m->nr_damage++] = desk;
+}
+
+static struct model_cmd *push_cmd(struct model *m, enum model_cmd_type type)
+{
+	struct model_cmd *cmd;
+
+	if (m->nr_cmds == m->alloc_cmds) {
+		m->alloc_cmds = m->alloc_cmds ? m->alloc_cmds * 2 : 8;
+		m->cmds = xrenew(struct model_cmd, m->cmds, m->alloc_cmds);
+	}
+	cmd = &m->cmds[m->nr_cmds++];
+	cmd->type = type;
+	cmd->window = 0;
+	cmd->desk = 0;
+	cmd->x = 0;
+	cmd->y = 0;
+	return cmd;
+}
+
+/* @desk: -1 = sticky */
+static struct grid *get_grid(struct model *m, int desk)
+{
+	struct model_desk *d = &m->desks[desk + 1];
+	int i;
+
+	if (!d->grid.dirty)
+		return &d->grid;
+
+	grid_clear(&d->grid, m->desk_w, m->desk_h);
+	for (i = 0; i < d->nr_windows; i++) {
+		struct model_client *c = &m->clients[d->windows[i]];
+
+		if (c->type == WINDOW_TYPE_DESKTOP)
+			continue;
+
+		if (c->states & WINDOW_STATE_HIDDEN)
+			continue;
+
+		grid_add(&d->grid, d->windows[i], c->px, c->py, c->pw, c->ph);
+	}
+	return &d->grid;
+}
+
+static void popup_show(struct model *m, int x_root, int row)
+{
+	struct model_cmd *cmd;
+
+	if (!m->show_popups)
+		return;
+
+	cmd = push_cmd(m, MODEL_POPUP_MOVE);
+	cmd->window = m->clients[m->popup_idx].window;
+	cmd->x = x_root;
+	cmd->desk = row;
+	if (!m->popup_visible) {
+		push_cmd(m, MODEL_POPUP_MAP);
+		m->popup_visible = 1;
+	}
+}
+
+static void popup_hide(struct model *m)
+{
+	if (m->popup_visible) {
+		push_cmd(m, MODEL_POPUP_UNMAP);
+		m->popup_visible = 0;
+	}
+}
+
+static void button_press(struct model *m, int x, int y, int button)
+{
+	struct geom_point p;
+
+	if (m->popup_visible)
+		popup_hide(m);
+	if (button != 1 && button != 2)
+		return;
+	if (m->mouse.button != -1)
+		return;
+
+	m->mouse.button = button;
+	m->mouse.dragging = 0;
+	m->mouse.click_x = x;
+	m->mouse.click_y = y;
+
+	geom_from_pager(&m->geom, x, y, &p);
+
+	m->mouse.window_idx = model_window_at(m, &p);
+	if (m->mouse.window_idx != -1) {
+		m->mouse.window_x = p.rx - m->clients[m->mouse.window_idx].x;
+		m->mouse.window_y = p.ry - m->clients[m->mouse.window_idx].y;
+	}
+}
+
+static void button_release(struct model *m, int x, int y, int button)
+{
+	struct geom_point p;
+	int desk;
+
+	if (m->mouse.button != button)
+		return;
+
+	geom_from_pager(&m->geom, x, y, &p);
+	desk = p.row * m->cols + p.col;
+
+	if (button == 1) {
+		if (m->mouse.window_idx == -1) {
+			push_cmd(m, MODEL_SET_DESKTOP)->desk = desk;
+			model_set_active(m, desk, m->active_win);
+		} else if (!m->mouse.dragging) {
+			unsigned long window = m->clients[m->mouse.window_idx].window;
+
+			push_cmd(m, MODEL_SET_DESKTOP)->desk = desk;
+			push_cmd(m, MODEL_ACTIVATE)->window = window;
+			model_set_active(m, desk, window);
+		}
+	} else if (button == 2) {
+	}
+
+	m->mouse.window_idx = -1;
+	m->mouse.button = -1;
+	m->mouse.dragging = 0;
+}
+
+static void motion(struct model *m, int x, int y, int x_root)
+{
+	struct geom_point p;
+	struct model_client *c;
+	struct model_cmd *cmd;
+	int desk;
+
+	geom_from_pager(&m->geom, x, y, &p);
+	if (m->mouse.button == -1) {
+		/* show / hide popup */
+		int idx;
+
+		idx = model_window_at(m, &p);
+		if (m->popup_visible) {
+			if (idx == -1) {
+				popup_hide(m);
+			} else if (idx != m->popup_idx) {
+				/* popup_show moves the mapped popup */
+				m->popup_idx = idx;
+				popup_show(m, x_root, p.row);
+			}
+		} else if (idx != -1) {
+			m->popup_idx = idx;
+			popup_show(m, x_root, p.row);
+		}
+	} else if (m->mouse.window_idx != -1) {
+		if (!m->mouse.dragging &&
+				abs(m->mouse.click_x - x) < DRAG_THRESHOLD &&
+				abs(m->mouse.click_y - y) < DRAG_THRESHOLD)
+			return;
+
+		/* move window */
+		m->mouse.dragging = 1;
+
+		desk = p.row * m->cols + p.col;
+		c = &m->clients[m->mouse.window_idx];
+		if (desk != c->desk && c->desk != -1) {
+			cmd = push_cmd(m, MODEL_SET_WINDOW_DESKTOP);
+			cmd->window = c->window;
+			cmd->desk = desk;
+			move_to_desk(m, m->mouse.window_idx, desk);
+		}
+		if (m->mouse.button == 1) {
+			/* move to other desk (already done :)) */
+		} else if (m->mouse.button == 2) {
+			/* exact placement */
+
+			/* can't set geometry of a shaded window */
+			if (c->states & WINDOW_STATE_SHADED)
+				push_cmd(m, MODEL_UNSHADE)->window = c->window;
+
+			cmd = push_cmd(m, MODEL_MOVE_WINDOW);
+			cmd->window = c->window;
+			cmd->x = p.rx - m->mouse.window_x;
+			cmd->y = p.ry - m->mouse.window_y;
+			c->x = cmd->x;
+			c->y = cmd->y;
+			update_rect(m, c);
+			invalidate_grid(m, c->desk);
+		}
+	}
+}
+
+static struct model_draw *push_draw(struct model_draw_list *list, enum model_draw_type type,
+		enum model_color color, int x, int y, int w, int h)
+{
+	struct model_draw *op;
+
+	if (list->nr == list->alloc) {
+		list->alloc = list->alloc ? list->alloc * 2 : 64;
+		list->ops = xrenew(struct model_draw, list->ops, list->alloc);
+	}
+	op = &list->ops[list->nr++];
+	op->type = type;
+	op->color = color;
+	op->r.x = x;
+	op->r.y = y;
+	op->r.w = w;
+	op->r.h = h;
+	op->text = NULL;
+	return op;
+}
+
+/* intersection of @clip and the rectangle. returns 0 if it is empty */
+static int clip_rect(struct model_rect *r, int x, int y, int w, int h, const struct model_rect *clip)
+{
+	int x2 = x + w;
+	int y2 = y + h;
+
+	if (x < clip->x)
+		x = clip->x;
+	if (y < clip->y)
+		y = clip->y;
+	if (x2 > clip->x + clip->w)
+		x2 = clip->x + clip->w;
+	if (y2 > clip->y + clip->h)
+		y2 = clip->y + clip->h;
+	if (x2 <= x || y2 <= y)
+		return 0;
+	r->x = x;
+	r->y = y;
+	r->w = x2 - x;
+	r->h = y2 - y;
+	return 1;
+}
+
+/* everything is clipped to @cell so windows don't leak to other desktops */
+static void paint_window(struct model *m, const struct model_client *c,
+		const struct model_rect *cell, struct model_draw_list *list)
+{
+	enum model_color color;
+	struct model_rect r, ra;
+	struct model_draw *op;
+	int px = cell->x + c->px;
+	int py = cell->y + c->py;
+	int pw = c->pw;
+	int ph = c->ph;
+
+	if (m->active_win == c->window) {
+		color = MODEL_ACTIVE_WIN;
+	} else {
+		color = MODEL_INACTIVE_WIN;
+	}
+
+	/* border is the 1 pixel of the outer rectangle not covered by the inner one */
+	if (!clip_rect(&r, px, py, pw, ph, cell))
+		return;
+	push_draw(list, MODEL_FILL, MODEL_WIN_BORDER, r.x, r.y, r.w, r.h);
+
+	px++;
+	py++;
+	pw -= 2;
+	ph -= 2;
+	if (!clip_rect(&r, px, py, pw, ph, cell))
+		return;
+	push_draw(list, MODEL_FILL, color, r.x, r.y, r.w, r.h);
+
+	if (m->show_window_titles) {
+		ra.x = px + TITLE_HPAD;
+		ra.y = py + TITLE_VPAD;
+		ra.w = pw - 2 * TITLE_HPAD;
+		ra.h = ph - 2 * TITLE_VPAD;
+
+		if (ra.w < 1 || ra.h < 1)
+			return;
+		if (!clip_rect(&r, ra.x, ra.y, ra.w, ra.h, cell))
+			return;
+
+		op = push_draw(list, MODEL_TEXT, color, ra.x, ra.y, ra.w, ra.h);
+		op->clip = r;
+		op->text = c->name;
+	}
+}
+
+static int is_drawn(const struct model_client *c)
+{
+	switch (c->type) {
+	case WINDOW_TYPE_DESKTOP:
+	case WINDOW_TYPE_MENU:
+		break;
+	case WINDOW_TYPE_DOCK:
+	case WINDOW_TYPE_TOOLBAR:
+	case WINDOW_TYPE_UTILITY:
+	case WINDOW_TYPE_SPLASH:
+	case WINDOW_TYPE_DIALOG:
+	case WINDOW_TYPE_NORMAL:
+		return !(c->states & WINDOW_STATE_HIDDEN);
+	}
+	return 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * PUBLIC
+ */
+
+void model_init(struct model *m, int cols, int rows, int root_w, int root_h)
+{
+	memset(m, 0, sizeof(*m));
+	m->cols = cols;
+	m->rows = rows;
+	m->root_w = root_w;
+	m->root_h = root_h;
+	geom_init(&m->geom);
+
+	m->popup_idx = -1;
+	m->show_sticky = 1;
+	m->show_window_titles = 1;
+	m->show_popups = 1;
+
+	m->mouse.window_idx = -1;
+	m->mouse.button = -1;
+	m->mouse.click_x = -1;
+	m->mouse.click_y = -1;
+
+	m->gen = 1;
+	m->painted_gen = 0;
+}
+
+void model_free(struct model *m)
+{
+	int i;
+
+	model_free_clients(m);
+	for (i = 0; i < m->nr_desks; i++)
+		desk_free(&m->desks[i]);
+	mem_free(MEM_CLIENTS, m->desks);
+	m->desks = NULL;
+	m->nr_desks = 0;
+	geom_free(&m->geom);
+	free(m->damage);
+	m->damage = NULL;
+	free(m->cmds);
+	m->cmds = NULL;
+}
+
+void model_free_clients(struct model *m)
+{
+	int i;
+
+	for (i = 0; i < m->nr_clients; i++) {
+		mem_free(MEM_TITLES, m->clients[i].name);
+		mem_free(MEM_ICONS, m->clients[i].icon_data);
+	}
+	mem_free(MEM_CLIENTS, m->clients);
+	m->clients = NULL;
+	m->nr_clients = 0;
+}
+
+int model_find(const struct model *m, unsigned long window)
+{
+	int i;
+
+	for (i = 0; i < m->nr_clients; i++) {
+		if (m->clients[i].window == window)
+			return i;
+	}
+	return -1;
+}
+
+void model_init_pending(struct model_client *c, unsigned long window)
+{
+	memset(c, 0, sizeof(*c));
+	c->window = window;
+	c->desk = -1;
+	c->pending = 1;
+}
+
+void model_replace_clients(struct model *m, struct model_client *clients, int nr)
+{
+	unsigned long move_win = 0, popup_win = 0;
+
+	if (m->mouse.window_idx != -1)
+		move_win = m->clients[m->mouse.window_idx].window;
+	if (m->popup_idx != -1)
+		popup_win = m->clients[m->popup_idx].window;
+
+	model_free_clients(m);
+	m->clients = clients;
+	m->nr_clients = nr;
+
+	m->mouse.window_idx = find_fetched(m, move_win);
+	m->popup_idx = find_fetched(m, popup_win);
+}
+
+void model_remove_pending(struct model *m)
+{
+	unsigned long move_win = 0, popup_win = 0;
+	int i, j;
+
+	if (m->mouse.window_idx != -1)
+		move_win = m->clients[m->mouse.window_idx].window;
+	if (m->popup_idx != -1)
+		popup_win = m->clients[m->popup_idx].window;
+
+	j = 0;
+	for (i = 0; i < m->nr_clients; i++) {
+		if (m->clients[i].pending)
+			continue;
+		if (j != i)
+			m->clients[j] = m->clients[i];
+		j++;
+	}
+	m->nr_clients = j;
+
+	m->mouse.window_idx = find_fetched(m, move_win);
+	m->popup_idx = find_fetched(m, popup_win);
+}
+
+void model_update_rects(struct model *m)
+{
+	int i;
+
+	for (i = 0; i < m->nr_clients; i++) {
+		struct model_client *c = &m->clients[i];
+		int px = c->px, py = c->py, pw = c->pw, ph = c->ph;
+
+		update_rect(m, c);
+		if (!c->pending && (c->px != px || c->py != py || c->pw != pw || c->ph != ph))
+			invalidate_grid(m, c->desk);
+	}
+	update_desks(m);
+}
+
+void model_client_changed(struct model *m, int idx, int old_desk)
+{
+	struct model_client *c = &m->clients[idx];
+	int desk = c->desk;
+
+	damage_desk(m, old_desk);
+	if (desk != old_desk) {
+		c->desk = old_desk;
+		move_to_desk(m, idx, desk);
+	} else {
+		invalidate_grid(m, desk);
+	}
+	update_rect(m, c);
+	damage_desk(m, desk);
+}
+
+int model_configure(struct model *m, int w, int h)
+{
+	int i;
+
+	/* moves and restacks of the pager window */
+	if (w == m->configured.w && h == m->configured.h &&
+			m->cols == m->configured.cols && m->rows == m->configured.rows &&
+			m->root_w == m->configured.root_w && m->root_h == m->configured.root_h) {
+		/* pager_calc_w_h() may have changed these meanwhile */
+		m->w = w;
+		m->h = h;
+		return 0;
+	}
+	m->configured.w = w;
+	m->configured.h = h;
+	m->configured.cols = m->cols;
+	m->configured.rows = m->rows;
+	m->configured.root_w = m->root_w;
+	m->configured.root_h = m->root_h;
+
+	m->w = w;
+	m->h = h;
+	m->gen++;
+
+	m->desk_w = (w - (m->cols - 1)) / m->cols;
+	m->desk_h = (h - (m->rows - 1)) / m->rows;
+	m->w_extra = w - m->cols * m->desk_w - (m->cols - 1);
+	m->h_extra = h - m->rows * m->desk_h - (m->rows - 1);
+	geom_configure(&m->geom, w, h, m->desk_w, m->desk_h, m->root_w, m->root_h);
+	model_update_rects(m);
+	/* grids cover one desktop cell */
+	for (i = 0; i < m->nr_desks; i++)
+		m->desks[i].grid.dirty = 1;
+	return 1;
+}
+
+void model_set_active(struct model *m, int desk, unsigned long window)
+{
+	int desks[4], nr = 0, i;
+
+	if (desk != m->active_desk) {
+		desks[nr++] = m->active_desk;
+		desks[nr++] = desk;
+		m->active_desk = desk;
+	}
+	if (window != m->active_win) {
+		desks[nr++] = active_win_desk(m);
+		m->active_win = window;
+		desks[nr++] = active_win_desk(m);
+	}
+
+	for (i = 0; i < nr; i++) {
+		if (desks[i] == -1) {
+			damage_desk(m, -1);
+			return;
+		}
+	}
+	for (i = 0; i < nr; i++)
+		damage_desk(m, desks[i]);
+}
+
+int model_window_at(struct model *m, const struct geom_point *p)
+{
+	int desk = p->row * m->cols + p->col;
+	int idx = -1;
+
+	if (p->col < 0 || p->col >= m->cols || p->row < 0 || p->row >= m->rows)
+		return -1;
+
+	if (get_desk(m, desk))
+		idx = grid_lookup(get_grid(m, desk), p->lx, p->ly);
+	if (m->show_sticky && m->nr_desks) {
+		int sticky = grid_lookup(get_grid(m, -1), p->lx, p->ly);
+
+		/* topmost wins */
+		if (sticky > idx)
+			idx = sticky;
+	}
+	return idx;
+}
+
+void model_handle_event(struct model *m, const struct model_event *e)
+{
+	switch (e->type) {
+	case MODEL_BUTTON_PRESS:
+		button_press(m, e->x, e->y, e->button);
+		break;
+	case MODEL_BUTTON_RELEASE:
+		button_release(m, e->x, e->y, e->button);
+		break;
+	case MODEL_MOTION:
+		motion(m, e->x, e->y, e->x_root);
+		break;
+	case MODEL_LEAVE:
+		popup_hide(m);
+		break;
+	}
+}
+
+void model_desk_rect(const struct model *m, int desk, struct model_rect *r)
+{
+	r->x = desk % m->cols * (m->desk_w + 1);
+	r->y = desk / m->cols * (m->desk_h + 1);
+	r->w = m->desk_w;
+	r->h = m->desk_h;
+}
+
+void model_paint_desk(struct model *m, int desk, struct model_draw_list *list)
+{
+	struct model_desk *d, *sticky;
+	struct model_rect cell;
+	int i, j, nr_sticky;
+
+	model_desk_rect(m, desk, &cell);
+	push_draw(list, MODEL_FILL,
+			desk == m->active_desk ? MODEL_ACTIVE_DESK : MODEL_INACTIVE_DESK,
+			cell.x, cell.y, cell.w, cell.h);
+
+	d = get_desk(m, desk);
+	if (m->showing_desktop || d == NULL)
+		return;
+
+	/* merge the desktop and sticky windows in stacking order */
+	sticky = &m->desks[0];
+	nr_sticky = m->show_sticky ? sticky->nr_windows : 0;
+	i = 0;
+	j = 0;
+	while (i < d->nr_windows || j < nr_sticky) {
+		int idx;
+
+		if (j == nr_sticky || (i < d->nr_windows && d->windows[i] < sticky->windows[j])) {
+			idx = d->windows[i++];
+		} else {
+			idx = sticky->windows[j++];
+		}
+		if (is_drawn(&m->clients[idx]))
+			paint_window(m, &m->clients[idx], &cell, list);
+	}
+}
+
+void model_paint(struct model *m, struct model_draw_list *list)
+{
+	int row, col, x, y, desk;
+
+	m->painted_gen = m->gen;
+	m->nr_damage = 0;
+
+	for (desk = 0; desk < m->cols * m->rows; desk++)
+		model_paint_desk(m, desk, list);
+
+	if (m->w_extra)
+		push_draw(list, MODEL_FILL, MODEL_INACTIVE_DESK,
+				m->w - m->w_extra, 0, m->w_extra, m->h);
+	if (m->h_extra)
+		push_draw(list, MODEL_FILL, MODEL_INACTIVE_DESK,
+				0, m->h - m->h_extra, m->w - m->w_extra, m->h_extra);
+
+	/* grid */
+	for (row = 1; row < m->rows; row++) {
+		y = row * (m->desk_h + 1) - 1;
+		push_draw(list, MODEL_LINE, MODEL_GRID, 0, y, m->w, 0);
+	}
+	for (col = 1; col < m->cols; col++) {
+		x = col * (m->desk_w + 1) - 1;
+		push_draw(list, MODEL_LINE, MODEL_GRID, x, 0, 0, m->h);
+	}
+}
+
+void model_draw_list_free(struct model_draw_list *list)
+{
+	free(list->ops);
+	list->ops = NULL;
+	list->nr = 0;
+	list->alloc = 0;
+}
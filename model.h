@@ -0,0 +1,299 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef _MODEL_H
+#define _MODEL_H
+
+/*
+ * Pager model without Xlib: client table, desktop layout, hit-testing,
+ * the mouse state machine and dirty tracking.
+ *
+ * Input arrives as struct model_event. Requests for the window manager
+ * and the popup are queued as struct model_cmd, drawing is described by
+ * struct model_draw lists. pager.c is the X backend which fills the
+ * client table and executes both.
+ */
+
+#include <netwm.h>
+#include <grid.h>
+#include <geom.h>
+
+struct model_rect {
+	int x, y, w, h;
+};
+
+struct model_client {
+	unsigned long window;
+	int x, y, w, h;
+
+	/* -1 = sticky */
+	int desk;
+
+	enum window_type type;
+	char *name;
+
+	/* WINDOW_STATE_* */
+	unsigned int states;
+
+	int icon_w, icon_h;
+	char *icon_data;
+
+	/* drawn (and clickable) rectangle relative to the desktop cell.
+	 * includes minimum size and shading. see model_update_rects() */
+	int px, py, pw, ph;
+
+	/* popup_extents is valid */
+	unsigned int has_popup_extents : 1;
+	/* MODEL_DIRTY_*, what the backend has to refetch */
+	unsigned int dirty : 5;
+	/* not fetched yet. only window is valid */
+	unsigned int pending : 1;
+	/* size of the title in the popup font, measured by the backend */
+	struct model_rect popup_extents;
+};
+
+/* model_client.dirty */
+enum model_dirty {
+	MODEL_DIRTY_TITLE = 1 << 0,
+	MODEL_DIRTY_DESK = 1 << 1,
+	MODEL_DIRTY_STATES = 1 << 2,
+	MODEL_DIRTY_TYPE = 1 << 3,
+	MODEL_DIRTY_GEOMETRY = 1 << 4
+};
+
+/* clients of one desktop */
+struct model_desk {
+	/* indexes to clients[] in stacking order */
+	int *windows;
+	int nr_windows;
+	int alloc;
+
+	/* hit-test index in root coordinates */
+	struct grid grid;
+};
+
+enum model_event_type {
+	MODEL_BUTTON_PRESS,
+	MODEL_BUTTON_RELEASE,
+	/* EnterNotify is handled like MotionNotify */
+	MODEL_MOTION,
+	MODEL_LEAVE
+};
+
+struct model_event {
+	enum model_event_type type;
+	/* pointer position relative to the pager window */
+	int x, y;
+	/* pointer position relative to the root window */
+	int x_root, y_root;
+	int button;
+};
+
+enum model_cmd_type {
+	/* desk */
+	MODEL_SET_DESKTOP,
+	/* window */
+	MODEL_ACTIVATE,
+	/* window, desk */
+	MODEL_SET_WINDOW_DESKTOP,
+	/* window */
+	MODEL_UNSHADE,
+	/* window, x, y in root coordinates */
+	MODEL_MOVE_WINDOW,
+	/* place popup of clients[popup_idx]. x = pointer x relative to
+	 * root window, desk = desktop row under the pointer */
+	MODEL_POPUP_MOVE,
+	MODEL_POPUP_MAP,
+	MODEL_POPUP_UNMAP
+};
+
+struct model_cmd {
+	enum model_cmd_type type;
+	unsigned long window;
+	int desk;
+	int x, y;
+};
+
+enum model_color {
+	MODEL_ACTIVE_WIN,
+	MODEL_INACTIVE_WIN,
+	MODEL_ACTIVE_DESK,
+	MODEL_INACTIVE_DESK,
+	MODEL_WIN_BORDER,
+	MODEL_GRID,
+	NR_MODEL_COLORS
+};
+
+enum model_draw_type {
+	/* fill r */
+	MODEL_FILL,
+	/* line from (r.x, r.y) to (r.x + r.w, r.y + r.h) */
+	MODEL_LINE,
+	/* text centered in r, clipped to clip. color is MODEL_ACTIVE_WIN
+	 * or MODEL_INACTIVE_WIN and selects the font color */
+	MODEL_TEXT
+};
+
+struct model_draw {
+	enum model_draw_type type;
+	enum model_color color;
+	struct model_rect r;
+	struct model_rect clip;
+	/* owned by the client, valid until the client table changes */
+	const char *text;
+};
+
+struct model_draw_list {
+	struct model_draw *ops;
+	int nr;
+	int alloc;
+};
+
+struct model {
+	struct model_client *clients;
+	int nr_clients;
+
+	/* clients[] split by desktop. desks[0] is for sticky clients,
+	 * desks[desk + 1] for others. see model_update_rects() */
+	struct model_desk *desks;
+	int nr_desks;
+
+	/* root window properties */
+	unsigned long active_win;
+	int active_desk;
+	int showing_desktop;
+
+	int cols, rows;
+
+	/* pager window size */
+	int w, h;
+
+	int root_w;
+	int root_h;
+	int desk_w;
+	int desk_h;
+
+	/* pixels not covered by desktop cells */
+	int w_extra;
+	int h_extra;
+
+	/* updated by model_configure() */
+	struct geom geom;
+	/* arguments and layout of the last model_configure() */
+	struct {
+		int w, h;
+		int cols, rows;
+		int root_w, root_h;
+	} configured;
+
+	/* index to clients[] or -1. used to get the title of the window */
+	int popup_idx;
+	unsigned int popup_visible : 1;
+
+	unsigned int show_sticky : 1;
+	unsigned int show_window_titles : 1;
+	unsigned int show_popups : 1;
+
+	struct {
+		/* index to clients[] or -1. the window we are moving */
+		int window_idx;
+
+		/* mouse coordinates relative to the window */
+		int window_x;
+		int window_y;
+
+		/* mouse button or -1 */
+		int button;
+
+		/* click coordinates relative to pager */
+		int click_x;
+		int click_y;
+
+		unsigned int dragging : 1;
+	} mouse;
+
+	/* gen is bumped whenever something visible changes, painted_gen
+	 * is the generation of the last model_paint() */
+	unsigned int gen;
+	unsigned int painted_gen;
+
+	/* desktops to repaint with model_paint_desk(). only used while
+	 * painted_gen == gen, otherwise everything is repainted anyway */
+	int *damage;
+	int nr_damage;
+	int alloc_damage;
+
+	/* queued for the backend, which resets nr_cmds */
+	struct model_cmd *cmds;
+	int nr_cmds;
+	int alloc_cmds;
+};
+
+extern void model_init(struct model *m, int cols, int rows, int root_w, int root_h);
+extern void model_free(struct model *m);
+
+/* frees clients[] */
+extern void model_free_clients(struct model *m);
+
+/* index of client @window or -1 */
+extern int model_find(const struct model *m, unsigned long window);
+
+/* placeholder for a client which is fetched later */
+extern void model_init_pending(struct model_client *c, unsigned long window);
+
+/* replaces clients[] with @clients (allocated with mem_new(MEM_CLIENTS),
+ * titles with MEM_TITLES). the old table is freed, popup and dragged
+ * window are looked up from the new one */
+extern void model_replace_clients(struct model *m, struct model_client *clients, int nr);
+
+/* removes pending clients */
+extern void model_remove_pending(struct model *m);
+
+/* must be called when desktop size or clients[] changes */
+extern void model_update_rects(struct model *m);
+
+/* clients[@idx] was refetched, @old_desk is its desktop before that.
+ * moves it between the desktop buckets and damages the old and new
+ * desktop cells instead of repainting everything */
+extern void model_client_changed(struct model *m, int idx, int old_desk);
+
+/* @w, @h: pager window size. returns 0 and keeps the rendered pager if
+ * neither the size nor the layout changed, 1 otherwise */
+extern int model_configure(struct model *m, int w, int h);
+
+/* shows @desk and @window as active, before the WM confirms a click or
+ * after it changed them. damages the desktops which need repainting */
+extern void model_set_active(struct model *m, int desk, unsigned long window);
+
+/* returns index to clients[] of the topmost window drawn at @p or -1 */
+extern int model_window_at(struct model *m, const struct geom_point *p);
+
+/* updates state and queues commands */
+extern void model_handle_event(struct model *m, const struct model_event *e);
+
+/* rectangle of desktop @desk in the pager window */
+extern void model_desk_rect(const struct model *m, int desk, struct model_rect *r);
+
+/* appends operations for the whole pager and sets painted_gen */
+extern void model_paint(struct model *m, struct model_draw_list *list);
+
+/* appends operations for one desktop cell, sticky windows included */
+extern void model_paint_desk(struct model *m, int desk, struct model_draw_list *list);
+
+extern void model_draw_list_free(struct model_draw_list *list);
+
+#endif
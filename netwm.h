@@ -0,0 +1,47 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef _NETWM_H
+#define _NETWM_H
+
+/* EWMH window states and types, shared by x.c and the model */
+
+#define WINDOW_STATE_MODAL		(1 << 0)
+#define WINDOW_STATE_STICKY		(1 << 1)
+#define WINDOW_STATE_MAXIMIZED_VERT	(1 << 2)
+#define WINDOW_STATE_MAXIMIZED_HORZ	(1 << 3)
+#define WINDOW_STATE_SHADED		(1 << 4)
+#define WINDOW_STATE_SKIP_TASKBAR	(1 << 5)
+#define WINDOW_STATE_SKIP_PAGER		(1 << 6)
+#define WINDOW_STATE_HIDDEN		(1 << 7)
+#define WINDOW_STATE_FULLSCREEN		(1 << 8)
+#define WINDOW_STATE_ABOVE		(1 << 9)
+#define WINDOW_STATE_BELOW		(1 << 10)
+#define WINDOW_STATE_DEMANDS_ATTENTION	(1 << 11)
+
+enum window_type {
+	WINDOW_TYPE_DESKTOP,
+	WINDOW_TYPE_DOCK,
+	WINDOW_TYPE_TOOLBAR,
+	WINDOW_TYPE_MENU,
+	WINDOW_TYPE_UTILITY,
+	WINDOW_TYPE_SPLASH,
+	WINDOW_TYPE_DIALOG,
+	WINDOW_TYPE_NORMAL
+};
+
+#endif
@@ -19,7 +19,15 @@
 
 #include <pager.h>
 #include <x.h>
+#include <model.h>
 #include <xmalloc.h>
+#include <grid.h>
+#include <geom.h>
+#include <hist.h>
+#include <stats.h>
+#include <trace.h>
+#include <replay.h>
+#include <profile.h>
 #include <debug.h>
 
 #include <X11/Xlib.h>
@@ -28,65 +36,36 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <unistd.h>
+#include <poll.h>
 
-#define WM_WAIT 15
-
-#define TITLE_HPAD	3
-#define TITLE_VPAD	1
 #define POPUP_PAD	5
 
-/* minimum draw size of window. makes moving small windows possible
- * these must be >= 2 (window borders take 2 pixels)
- */
-#define WINDOW_MIN_W	3
-#define WINDOW_MIN_H	3
-
-#define WINDOW_SHADED_H	12
+/* max number of X requests used for fetching clients between input events */
+#define REFRESH_BUDGET	64
 
-#define DRAG_THRESHOLD	2
+/* root state is re-read if the WM does not confirm a click in time */
+#define CONFIRM_TIMEOUT_US	300000
 
 /* ---------------------------------------------------------------------------
  * PRIVATE
  */
 
-struct client_window {
-	Window window;
-	int x, y, w, h;
-
-	/* -1 = sticky */
-	int desk;
-
-	enum window_type type;
-	char *name;
-
-	/* WINDOW_STATE_* */
-	unsigned int states;
-
-	int icon_w, icon_h;
-	char *icon_data;
-};
-
 struct pager {
+	/* clients, desktop layout and input state */
+	struct model model;
+
 	Window window;
 	Window popup_window;
+	/* background of window, pixmap_w x pixmap_h */
 	Pixmap pixmap;
-	GC active_win_gc;
-	GC inactive_win_gc;
-	GC active_desk_gc;
-	GC inactive_desk_gc;
-	GC win_border_gc;
-	GC grid_gc;
-
-	struct client_window *windows;
-	int nr_windows;
-
-	Window active_win;
-	int active_desk;
+	int pixmap_w, pixmap_h;
+	/* indexed by enum model_color */
+	GC gc[NR_MODEL_COLORS];
 
-	int cols, rows;
+	/* filled by the model, reused by every repaint */
+	struct model_draw_list draw;
 
 	int x, y;
-	int w, h;
 
 	/* user set geometry, these are constants
 	 *
@@ -99,53 +78,45 @@ struct pager {
 	unsigned int gx_negative : 1;
 	unsigned int gy_negative : 1;
 
-	int root_w;
-	int root_h;
-	int desk_w;
-	int desk_h;
-
-	int w_extra;
-	int h_extra;
-
-	/* index to windows[] or -1. used to get the title of the window */
-	int popup_idx;
-	XGlyphInfo popup_extents;
-
-	unsigned int popup_visible : 1;
+	/* pending clients fetched by pager_refresh_step() */
+	struct {
+		/* index to clients[] */
+		int *queue;
+		int nr_queue;
+		/* desktops of queue[0..probed) are known */
+		int probed;
+		/* queue[0..fetched) are fetched */
+		int fetched;
+		/* queue[0..nr_urgent) are probed and on the current desktop
+		 * or sticky, they are moved here when probed */
+		int nr_urgent;
+
+		unsigned int active : 1;
+	} refresh;
+
+	/* active desktop and window before a click was shown optimistically.
+	 * pending until the WM changes the root property */
+	struct {
+		unsigned long long deadline;
+		int desk;
+		Window win;
+		unsigned int desk_pending : 1;
+		unsigned int win_pending : 1;
+	} confirm;
 
 	unsigned int needs_configure : 1;
-	unsigned int needs_update : 1;
 	unsigned int needs_update_properties : 1;
+	/* some client is dirty */
+	unsigned int needs_update_clients : 1;
 	unsigned int needs_update_popup : 1;
 
-	unsigned int show_sticky : 1;
-	unsigned int show_window_titles : 1;
 	unsigned int show_window_icons : 1;
-	unsigned int show_popups : 1;
 	unsigned int allow_cover : 1;
 
 	double opacity;
 
 	enum pager_layer layer;
 
-	struct {
-		/* index to windows[] or -1. the window we are moving */
-		int window_idx;
-
-		/* mouse coordinates relative to the pager window */
-		int window_x;
-		int window_y;
-
-		/* mouse button or -1 */
-		int button;
-
-		/* click coordinates relative to pager */
-		int click_x;
-		int click_y;
-
-		unsigned int dragging : 1;
-	} mouse;
-
 	XftDraw *xft_draw;
 	XftColor active_win_font_color;
 	XftColor inactive_win_font_color;
@@ -154,17 +125,12 @@ struct pager {
 	XftFont *popup_font;
 };
 
-static GC make_gc(Window window, const char *color)
+static GC make_gc(Window window, unsigned long fg)
 {
 	GC gc;
 	XGCValues values;
-	unsigned long fg;
-/* 	unsigned long bg; */
-	
-	x_parse_color(color, &fg);
+
 	values.foreground = fg;
-/* 	x_parse_color("rgb:ff/00/00", &bg); */
-/* 	values.background = bg; */
 	values.line_width = 1;
 	values.line_style = LineSolid;
 	gc = XCreateGC(display, window, GCForeground, &values);
@@ -173,28 +139,15 @@ static GC make_gc(Window window, const char *color)
 	return gc;
 }
 
-static void pager_free_windows(struct pager *pager)
-{
-	int i;
-
-	for (i = 0; i < pager->nr_windows; i++) {
-		free(pager->windows[i].name);
-		free(pager->windows[i].icon_data);
-	}
-	free(pager->windows);
-	pager->windows = NULL;
-	pager->nr_windows = 0;
-}
-
 static void pager_calc_x_y(struct pager *pager)
 {
 	if (pager->gx_negative) {
-		pager->x = pager->root_w - pager->w - pager->gx;
+		pager->x = pager->model.root_w - pager->model.w - pager->gx;
 	} else {
 		pager->x = pager->gx;
 	}
 	if (pager->gy_negative) {
-		pager->y = pager->root_h - pager->h - pager->gy;
+		pager->y = pager->model.root_h - pager->model.h - pager->gy;
 	} else {
 		pager->y = pager->gy;
 	}
@@ -205,514 +158,661 @@ static void pager_update_strut(struct pager *pager)
 	if (pager->allow_cover)
 		return;
 
-	if (pager->x >= pager->root_w || pager->y >= pager->root_h) {
-		d_print("pager is outside of screen (%d,%d %dx%d)\n", pager->x, pager->y, pager->w, pager->h);
+	if (pager->x >= pager->model.root_w || pager->y >= pager->model.root_h) {
+		d_print("pager is outside of screen (%d,%d %dx%d)\n", pager->x, pager->y, pager->model.w, pager->model.h);
 		return;
 	}
 
-	if (pager->w > pager->h) {
+	if (pager->model.w > pager->model.h) {
 		if (pager->y == 0) {
-			x_window_set_strut_partial(pager->window, STRUT_TYPE_TOP, pager->h, pager->x, pager->x + pager->w);
-		} else if (pager->y + pager->h == pager->root_h) {
-			x_window_set_strut_partial(pager->window, STRUT_TYPE_BOTTOM, pager->h, pager->x, pager->x + pager->w);
+			x_window_set_strut_partial(pager->window, STRUT_TYPE_TOP, pager->model.h, pager->x, pager->x + pager->model.w);
+		} else if (pager->y + pager->model.h == pager->model.root_h) {
+			x_window_set_strut_partial(pager->window, STRUT_TYPE_BOTTOM, pager->model.h, pager->x, pager->x + pager->model.w);
 		} else {
-			d_print("pager not at edge of screen (%d,%d %dx%d)\n", pager->x, pager->y, pager->w, pager->h);
+			d_print("pager not at edge of screen (%d,%d %dx%d)\n", pager->x, pager->y, pager->model.w, pager->model.h);
 		}
 	} else {
 		if (pager->x == 0) {
-			x_window_set_strut_partial(pager->window, STRUT_TYPE_LEFT, pager->w, pager->y, pager->y + pager->h);
-		} else if (pager->x + pager->w == pager->root_w) {
-			x_window_set_strut_partial(pager->window, STRUT_TYPE_RIGHT, pager->w, pager->y, pager->y + pager->h);
+			x_window_set_strut_partial(pager->window, STRUT_TYPE_LEFT, pager->model.w, pager->y, pager->y + pager->model.h);
+		} else if (pager->x + pager->model.w == pager->model.root_w) {
+			x_window_set_strut_partial(pager->window, STRUT_TYPE_RIGHT, pager->model.w, pager->y, pager->y + pager->model.h);
 		} else {
-			d_print("pager not at edge of screen (%d,%d %dx%d)\n", pager->x, pager->y, pager->w, pager->h);
+			d_print("pager not at edge of screen (%d,%d %dx%d)\n", pager->x, pager->y, pager->model.w, pager->model.h);
 		}
 	}
 }
 
+#if DEBUG > 0
+/* pixmaps created by pager_create_pixmap() */
+static unsigned long nr_pixmap_allocs;
+
+/* server side size. depth 24 is stored with 32 bits per pixel */
+static long pixmap_bytes(int w, int h)
+{
+	int depth = DefaultDepth(display, DefaultScreen(display));
+
+	return (long)w * h * (depth > 16 ? 4 : depth > 8 ? 2 : 1);
+}
+#endif
+
+/* (re)create pixmap with size of the pager window */
+static void pager_create_pixmap(struct pager *pager)
+{
+	if (pager->pixmap) {
+		XFreePixmap(display, pager->pixmap);
+#if DEBUG > 0
+		MEM_ADD(MEM_PIXMAPS, -pixmap_bytes(pager->pixmap_w, pager->pixmap_h));
+#endif
+	}
+	pager->pixmap = XCreatePixmap(display,
+			pager->window,
+			pager->model.w,
+			pager->model.h,
+			DefaultDepth(display, DefaultScreen(display)));
+	pager->pixmap_w = pager->model.w;
+	pager->pixmap_h = pager->model.h;
+#if DEBUG > 0
+	MEM_ADD(MEM_PIXMAPS, pixmap_bytes(pager->pixmap_w, pager->pixmap_h));
+	nr_pixmap_allocs++;
+	d_print("pixmap %dx%d created (%lu so far)\n", pager->model.w, pager->model.h, nr_pixmap_allocs);
+#endif
+}
+
 static void pager_configure(struct pager *pager)
 {
-	int x, y;
+	int x, y, w, h, changed;
 
-	if (x_window_get_geometry(pager->window, &x, &y, &pager->w, &pager->h)) {
+	if (x_window_get_geometry(pager->window, &x, &y, &w, &h)) {
 		d_print("x_window_get_geometry failed\n");
 		return;
 	}
+	pager->needs_configure = 0;
+	/* nothing to render if only position or stacking changed */
+	changed = model_configure(&pager->model, w, h);
+
 	pager_calc_x_y(pager);
 	if (x != pager->x || y != pager->y) {
 		d_print("forcing position\n");
 		x_window_set_geometry(pager->window, XValue | YValue, pager->x, pager->y, 0, 0);
 	}
-
-	pager->needs_configure = 0;
-	pager->needs_update = 1;
-
-	pager->desk_w = (pager->w - (pager->cols - 1)) / pager->cols;
-	pager->desk_h = (pager->h - (pager->rows - 1)) / pager->rows;
-	pager->w_extra = pager->w - pager->cols * pager->desk_w - (pager->cols - 1);
-	pager->h_extra = pager->h - pager->rows * pager->desk_h - (pager->rows - 1);
-	XFreePixmap(display, pager->pixmap);
-	pager->pixmap = XCreatePixmap(display,
-			pager->window,
-			pager->w,
-			pager->h,
-			DefaultDepth(display, DefaultScreen(display)));
-	XSetWindowBackgroundPixmap(display, pager->window, pager->pixmap);
+	if (!changed)
+		return;
+	if (pager->model.w != pager->pixmap_w || pager->model.h != pager->pixmap_h) {
+		pager_create_pixmap(pager);
+		XSetWindowBackgroundPixmap(display, pager->window, pager->pixmap);
+	}
 	pager_update_strut(pager);
 }
 
 static void pager_calc_w_h(struct pager *pager)
 {
-	pager->w = pager->gw;
-	pager->h = pager->gh;
+	pager->model.w = pager->gw;
+	pager->model.h = pager->gh;
 	if (!pager->gh)
-		pager->h = pager->w * (pager->root_h * pager->rows) / (pager->root_w * pager->cols);
+		pager->model.h = pager->model.w * (pager->model.root_h * pager->model.rows) / (pager->model.root_w * pager->model.cols);
 }
 
 static void pager_update_aspect(struct pager *pager)
 {
 	if (!pager->gh)
 		x_window_set_aspect(pager->window,
-				pager->root_w * pager->cols,
-				pager->root_h * pager->rows);
+				pager->model.root_w * pager->model.cols,
+				pager->model.root_h * pager->model.rows);
 }
 
 static void update_desktop_count(struct pager *pager)
 {
-	int rows = pager->rows;
-	int cols = pager->cols;
+	int rows = pager->model.rows;
+	int cols = pager->model.cols;
 
 	if (x_get_desktop_layout(&cols, &rows)) {
 		d_print("x_get_desktop_layout failed\n");
 	}
-	if (rows != pager->rows || cols != pager->cols) {
-		pager->rows = rows;
-		pager->cols = cols;
+	if (rows != pager->model.rows || cols != pager->model.cols) {
+		pager->model.rows = rows;
+		pager->model.cols = cols;
 		pager_update_aspect(pager);
 
 		pager_calc_w_h(pager);
 		/* pager_configure sets right values for these */
-		pager->w_extra = 0;
-		pager->h_extra = 0;
+		pager->model.w_extra = 0;
+		pager->model.h_extra = 0;
 
-		if (x_window_set_geometry(pager->window, WidthValue | HeightValue, 0, 0, pager->w, pager->h)) {
+		if (x_window_set_geometry(pager->window, WidthValue | HeightValue, 0, 0, pager->model.w, pager->model.h)) {
 		}
-		XFreePixmap(display, pager->pixmap);
-		pager->pixmap = XCreatePixmap(display,
-				pager->window,
-				pager->w,
-				pager->h,
-				DefaultDepth(display, DefaultScreen(display)));
-
+		/* pager_configure resizes the pixmap */
 		pager->needs_configure = 1;
 	}
 }
 
-static int get_window_index(struct pager *pager, Window window)
+/* re-read cached root window property @atom, or all of them if @atom is None */
+static void read_root_state(struct pager *pager, Atom atom)
 {
-	int i;
+	int showing_desktop = pager->model.showing_desktop;
+	int active_desk = pager->model.active_desk;
+	unsigned long active_win = pager->model.active_win;
 
-	for (i = 0; i < pager->nr_windows; i++) {
-		struct client_window *win = &pager->windows[i];
-
-		if (win->window == window)
-			return i;
+	if (atom == None || atom == x_get_atom(_NET_SHOWING_DESKTOP)) {
+		pager->model.showing_desktop = 0;
+		if (x_get_showing_desktop(&pager->model.showing_desktop)) {
+		}
 	}
-	return -1;
+	/* pre-click state if the property can't be read */
+	if (atom == None || atom == x_get_atom(_NET_CURRENT_DESKTOP)) {
+		if (x_get_current_desktop(&active_desk) && pager->confirm.desk_pending)
+			active_desk = pager->confirm.desk;
+		pager->confirm.desk_pending = 0;
+	}
+	if (atom == None || atom == x_get_atom(_NET_ACTIVE_WINDOW)) {
+		if (x_get_active_window(&active_win) && pager->confirm.win_pending)
+			active_win = pager->confirm.win;
+		pager->confirm.win_pending = 0;
+	}
+	if (!pager->confirm.desk_pending && !pager->confirm.win_pending)
+		pager->confirm.deadline = 0;
+	if (atom == None || atom == x_get_atom(_NET_NUMBER_OF_DESKTOPS) ||
+			atom == x_get_atom(_NET_DESKTOP_LAYOUT))
+		update_desktop_count(pager);
+
+	if (atom == None || showing_desktop != pager->model.showing_desktop) {
+		pager->model.active_desk = active_desk;
+		pager->model.active_win = active_win;
+		pager->model.gen++;
+		return;
+	}
+	/* repaints only the cells which change. nothing to draw if the WM
+	 * just confirmed what a click already painted */
+	model_set_active(&pager->model, active_desk, active_win);
+}
+
+/* WM did not confirm a click, show what it really has */
+static void confirm_timeout(struct pager *pager)
+{
+	d_print("WM did not confirm%s%s\n",
+			pager->confirm.desk_pending ? " desktop" : "",
+			pager->confirm.win_pending ? " active window" : "");
+	if (pager->confirm.desk_pending)
+		read_root_state(pager, x_get_atom(_NET_CURRENT_DESKTOP));
+	if (pager->confirm.win_pending)
+		read_root_state(pager, x_get_atom(_NET_ACTIVE_WINDOW));
+	pager->confirm.deadline = 0;
+}
+
+static int confirm_expired(struct pager *pager)
+{
+	return pager->confirm.deadline && time_us() >= pager->confirm.deadline;
 }
 
 extern int ignore_bad_window;
 
-static void pager_update_properties(struct pager *pager)
+/* @desk has been read by refresh_probe() */
+static int do_fetch_client(struct model_client *win, Window window, int desk)
 {
-	Window move_win = -1, popup_win = -1;
-	Window *windows;
-	int nr_windows;
-	int i, j;
+	win->window = window;
 
-	update_desktop_count(pager);
+	ignore_bad_window = 1;
 
-	/* stacking order */
-	if (x_get_client_list(1, &windows, &nr_windows) == -1) {
-		fprintf(stderr, "x_get_client_list (stacking order) failed\n");
-		return;
+	win->type = WINDOW_TYPE_NORMAL;
+	if (x_window_get_type(win->window, &win->type)) {
+/* 		fprintf(stderr, "could not get window type of window 0x%x\n", (int)window); */
 	}
 
-	pager->needs_update_properties = 0;
-	pager->needs_update = 1;
+	win->states = 0;
+	if (x_window_get_states(win->window, &win->states)) {
+/* 		fprintf(stderr, "could not get states of window 0x%x\n", (int)window); */
+		ignore_bad_window = 0;
+		return -1;
+	}
 
-	if (pager->mouse.window_idx != -1)
-		move_win = pager->windows[pager->mouse.window_idx].window;
-	if (pager->popup_idx != -1)
-		popup_win = pager->windows[pager->popup_idx].window;
+	ignore_bad_window = 0;
 
-	pager_free_windows(pager);
+	if (win->states & WINDOW_STATE_SKIP_PAGER) {
+/* 		d_print("skip pager 0x%x\n", (int)window); */
+		return -1;
+	}
+	win->desk = desk;
 
-	pager->nr_windows = nr_windows;
-	pager->windows = xnew(struct client_window, pager->nr_windows);
+	if (x_window_get_geometry(win->window, &win->x, &win->y, &win->w, &win->h)) {
+		fprintf(stderr, "could not get geometry of window 0x%x\n", (int)win->window);
+		return -1;
+	}
+	if (x_window_get_title(win->window, &win->name)) {
+		fprintf(stderr, "could not get name of window 0x%x\n", (int)win->window);
+		win->name = mem_strdup(MEM_TITLES, "?");
+	}
+	win->icon_w = -1;
+	win->icon_h = -1;
+	win->icon_data = NULL;
+	win->has_popup_extents = 0;
+	win->dirty = 0;
+	win->pending = 0;
+	STAT_INC(clients_fetched);
+/* 	d_print("new window 0x%x '%s'\n", (int)win->window, win->name); */
+	return 0;
+}
 
-	j = 0;
-	for (i = 0; i < pager->nr_windows; i++) {
-		struct client_window *win = &pager->windows[j];
+/* returns 0 if @window should be shown in the pager */
+static int fetch_client(struct model_client *win, Window window, int desk)
+{
+	int rc;
 
-		win->window = windows[i];
+	trace_begin("fetch_client", "\"window\":%lu", (unsigned long)window);
+	rc = do_fetch_client(win, window, desk);
+	trace_end("fetch_client");
+	return rc;
+}
 
-		ignore_bad_window = 1;
+/*
+ * New client table is built from the stacking order right away. Known
+ * clients are moved from the old table as is, their changes are tracked
+ * by PropertyNotify and ConfigureNotify. New (and dirty) clients are
+ * added as pending and fetched by pager_refresh_step() in slices of
+ * REFRESH_BUDGET requests so that input events can be handled and the
+ * pager can be painted between the slices.
+ */
+#if DEBUG > 0
+/* start of the refresh, for stats */
+static unsigned long long refresh_start_us;
+static unsigned long refresh_start_request;
+#endif
 
-		win->type = WINDOW_TYPE_NORMAL;
-		if (x_window_get_type(win->window, &win->type)) {
-/* 			fprintf(stderr, "could not get window type of window 0x%x\n", (int)windows[i]); */
-/* 			continue; */
-		}
+static void pager_refresh_start(struct pager *pager)
+{
+	struct model_client *windows;
+	Window *clients;
+	int nr_clients, nr, i;
 
-		win->states = 0;
-		if (x_window_get_states(win->window, &win->states)) {
-/* 			fprintf(stderr, "could not get states of window 0x%x\n", (int)windows[i]); */
-			continue;
-		}
+	pager->needs_update_properties = 0;
+	profile_begin(PROFILE_REFRESH);
+#if DEBUG > 0
+	refresh_start_us = time_us();
+	refresh_start_request = NextRequest(display);
+#endif
 
-		ignore_bad_window = 0;
+	/* stacking order */
+	if (x_get_client_list(1, &clients, &nr_clients) == -1) {
+		fprintf(stderr, "x_get_client_list (stacking order) failed\n");
+		return;
+	}
 
-		if (win->states & WINDOW_STATE_SKIP_PAGER) {
-/* 			d_print("skip pager 0x%x\n", (int)windows[i]); */
-			continue;
-		}
-		win->desk = -1;
-		if (x_window_get_desktop(win->window, &win->desk)) {
-			fprintf(stderr, "could not get desktop of window 0x%x\n", (int)win->window);
-			continue;
-		}
+	windows = mem_new(MEM_CLIENTS, struct model_client, nr_clients);
+	pager->refresh.queue = mem_new(MEM_CLIENTS, int, nr_clients);
+	pager->refresh.nr_queue = 0;
+	nr = 0;
+	for (i = 0; i < nr_clients; i++) {
+		struct model_client *old;
+		int idx;
 
-		if (x_window_get_geometry(win->window, &win->x, &win->y, &win->w, &win->h)) {
-			fprintf(stderr, "could not get geometry of window 0x%x\n", (int)win->window);
+		/* XSelectInput in fetch_client would replace our event mask */
+		if (clients[i] == pager->window)
 			continue;
-		}
-		if (x_window_get_title(win->window, &win->name)) {
-			fprintf(stderr, "could not get name of window 0x%x\n", (int)win->window);
-			/* continue; */
-			win->name = xstrdup("?");
-		}
-		win->icon_w = -1;
-		win->icon_h = -1;
-		win->icon_data = NULL;
-/* 		d_print("new window 0x%x '%s'\n", (int)win->window, win->name); */
 
-		/* FIXME: breaks sometimes */
-/* 		XSelectInput(display, win->window, PropertyChangeMask); */
-		j++;
+		idx = model_find(&pager->model, clients[i]);
+		old = idx == -1 ? NULL : &pager->model.clients[idx];
+		if (old && !old->dirty && !old->pending) {
+			windows[nr] = *old;
+			/* owned by the new table now */
+			old->name = NULL;
+			old->icon_data = NULL;
+		} else {
+			/* once, when the client enters the table. before
+			 * reading anything so that no change is missed.
+			 * XSelectInput has no reply, a BadWindow for a
+			 * client which is already gone arrives with the
+			 * reply of the first probe, which ignores it */
+			if (!old)
+				XSelectInput(display, clients[i], StructureNotifyMask | PropertyChangeMask);
+			model_init_pending(&windows[nr], clients[i]);
+			pager->refresh.queue[pager->refresh.nr_queue++] = nr;
+		}
+		nr++;
 	}
-	ignore_bad_window = 0;
-	pager->nr_windows = j;
-	free(windows);
+	free(clients);
+
+	/* frees clients which are not in the list anymore */
+	model_replace_clients(&pager->model, windows, nr);
 
-	if (move_win != -1)
-		pager->mouse.window_idx = get_window_index(pager, move_win);
-	if (popup_win != -1)
-		pager->popup_idx = get_window_index(pager, popup_win);
+	pager->refresh.probed = 0;
+	pager->refresh.fetched = 0;
+	pager->refresh.nr_urgent = 0;
+	pager->refresh.active = 1;
 
-	x_get_current_desktop(&pager->active_desk);
-	x_get_active_window(&pager->active_win);
+	/* not painted until the current desktop is complete */
+	model_update_rects(&pager->model);
 }
 
-static void do_draw_window(struct pager *pager, struct client_window *window, int px, int py, int pw, int ph)
+/* all clients on the current desktop and sticky ones are fetched */
+static int refresh_urgent_done(struct pager *pager)
 {
-	GC gc;
+	return pager->refresh.probed == pager->refresh.nr_queue &&
+		pager->refresh.fetched >= pager->refresh.nr_urgent;
+}
 
-	if (pager->active_win == window->window) {
-		gc = pager->active_win_gc;
-	} else {
-		gc = pager->inactive_win_gc;
-	}
+/* reads desktop of queue[probed] and moves it to the urgent part of the
+ * queue if it is on the current desktop or sticky. a client without a
+ * desktop is not fetched at all, it stays pending and is removed by
+ * pager_refresh_finish() */
+static void refresh_probe(struct pager *pager)
+{
+	int *queue = pager->refresh.queue;
+	int i = pager->refresh.probed;
+	struct model_client *win = &pager->model.clients[queue[i]];
+	int rc;
+
+	trace_begin("probe_desktop", "\"window\":%lu", (unsigned long)win->window);
+	ignore_bad_window = 1;
+	rc = x_window_get_desktop(win->window, &win->desk);
+	ignore_bad_window = 0;
+	trace_end("probe_desktop");
 
-	/* NOTE: XDrawRectangle draws rectangle one pixel larger than XFillRectangle */
-	XDrawRectangle(display, pager->pixmap, pager->win_border_gc, px, py, pw - 1, ph - 1);
+	if (rc) {
+		/* destroyed or no _NET_WM_DESKTOP, drop from the queue */
+		queue[i] = queue[--pager->refresh.nr_queue];
+		return;
+	}
+	pager->refresh.probed++;
 
-	px++;
-	py++;
-	pw -= 2;
-	ph -= 2;
-	XFillRectangle(display, pager->pixmap, gc, px, py, pw, ph);
+	if (win->desk == pager->model.active_desk || win->desk == -1) {
+		int u = pager->refresh.nr_urgent++;
+		int tmp = queue[u];
 
-	if (pager->show_window_titles) {
-		XftColor *color;
-		XGlyphInfo extents;
-		XRectangle ra;
-		int len = strlen(window->name);
-		int x, y, w, h;
+		queue[u] = queue[i];
+		queue[i] = tmp;
+	}
+}
 
-		ra.x = px + TITLE_HPAD;
-		ra.y = py + TITLE_VPAD;
-		w = pw - 2 * TITLE_HPAD;
-		h = ph - 2 * TITLE_VPAD;
+/*
+ * Desktops of the pending clients are read one request each. A client
+ * on the current desktop (or sticky) is fetched as soon as its desktop
+ * is known, the other ones after all desktops have been probed.
+ *
+ * returns 1 when all clients have been fetched
+ */
+static int pager_refresh_step(struct pager *pager)
+{
+	unsigned long start = NextRequest(display);
+	int fetched = pager->refresh.fetched;
+	int urgent_done = refresh_urgent_done(pager);
+
+	while (NextRequest(display) - start < REFRESH_BUDGET &&
+			pager->refresh.fetched < pager->refresh.nr_queue) {
+		struct model_client *win;
+		struct model_client tmp;
+
+		if (pager->refresh.fetched >= pager->refresh.nr_urgent &&
+				pager->refresh.probed < pager->refresh.nr_queue) {
+			refresh_probe(pager);
+			continue;
+		}
+		win = &pager->model.clients[pager->refresh.queue[pager->refresh.fetched++]];
+		/* failed ones stay pending and are removed at the end */
+		if (fetch_client(&tmp, win->window, win->desk) == 0)
+			*win = tmp;
+	}
 
-		if (w < 1 || h < 1)
-			return;
+	/* paint when the current desktop is complete and after that
+	 * whenever something new was fetched */
+	if (refresh_urgent_done(pager) &&
+			(!urgent_done || pager->refresh.fetched != fetched)) {
+		model_update_rects(&pager->model);
+		pager->model.gen++;
+	}
+	return pager->refresh.fetched == pager->refresh.nr_queue;
+}
 
-		ra.width = w;
-		ra.height = h;
+/* @what: MODEL_DIRTY_* */
+static void pager_dirty_client(struct pager *pager, Window window, unsigned int what)
+{
+	int i = model_find(&pager->model, window);
 
-		XftTextExtentsUtf8(display, pager->window_font, (FcChar8 *)window->name, len, &extents);
-/* 		d_print("w = %d, h = %d, x = %d, y = %d, xoff = %d, yoff = %d\n", extents.width, extents.height, extents.x, extents.y, extents.xOff, extents.yOff); */
+	/* pending clients are fetched anyway */
+	if (i != -1 && !pager->model.clients[i].pending) {
+		pager->model.clients[i].dirty |= what;
+		pager->needs_update_clients = 1;
+	}
+}
 
-		x = ra.x + extents.x;
-		y = ra.y + extents.y;
-		if (extents.width < ra.width)
-			x += (ra.width - extents.width) / 2;
-		y += (ra.height - extents.height) / 2;
+/* reads only what changed. returns -1 if the client is gone or should
+ * not be shown anymore */
+static int refetch_client(struct pager *pager, struct model_client *win)
+{
+	int rc = 0;
 
-		if (pager->active_win == window->window) {
-			color = &pager->active_win_font_color;
-		} else {
-			color = &pager->inactive_win_font_color;
+	ignore_bad_window = 1;
+	if (win->dirty & MODEL_DIRTY_STATES) {
+		rc = x_window_get_states(win->window, &win->states);
+		if (win->states & WINDOW_STATE_SKIP_PAGER)
+			rc = -1;
+	}
+	if (!rc && (win->dirty & MODEL_DIRTY_TYPE)) {
+		win->type = WINDOW_TYPE_NORMAL;
+		x_window_get_type(win->window, &win->type);
+	}
+	if (!rc && (win->dirty & MODEL_DIRTY_DESK))
+		rc = x_window_get_desktop(win->window, &win->desk);
+	if (!rc && (win->dirty & MODEL_DIRTY_GEOMETRY))
+		rc = x_window_get_geometry(win->window, &win->x, &win->y, &win->w, &win->h);
+	if (!rc && (win->dirty & MODEL_DIRTY_TITLE)) {
+		char *name;
+
+		if (x_window_get_title(win->window, &name) == 0) {
+			mem_free(MEM_TITLES, win->name);
+			win->name = name;
+			win->has_popup_extents = 0;
+			if (pager->model.popup_idx == win - pager->model.clients)
+				pager->needs_update_popup = 1;
 		}
-		XftDrawSetClipRectangles(pager->xft_draw, 0, 0, &ra, 1);
-		XftDrawStringUtf8(pager->xft_draw, color,
-				pager->window_font, x, y,
-				(FcChar8 *)window->name, len);
 	}
+	ignore_bad_window = 0;
+	return rc ? -1 : 0;
 }
 
-static void draw_window(struct pager *pager, struct client_window *window)
+/* re-fetch dirty clients only and repaint their desktop cells */
+static void pager_update_clients(struct pager *pager)
 {
-	int col, row;
-	int x_off, y_off;
-	double x_scale, y_scale;
-	int px, py, pw, ph;
-
-	x_scale = (double)pager->root_w / (double)pager->desk_w;
-	y_scale = (double)pager->root_h / (double)pager->desk_h;
-
-	px = (int)((double)window->x / x_scale);
-	py = (int)((double)window->y / y_scale);
-	pw = (int)((double)window->w / x_scale);
-	if (window->states & WINDOW_STATE_SHADED) {
-		ph = (int)((double)WINDOW_SHADED_H / y_scale);
-	} else {
-		ph = (int)((double)window->h / y_scale);
-	}
-
-	if (pw < WINDOW_MIN_W)
-		pw = WINDOW_MIN_W;
-	if (ph < WINDOW_MIN_H)
-		ph = WINDOW_MIN_H;
+	int i;
 
-	XftDrawChange(pager->xft_draw, pager->pixmap);
+	pager->needs_update_clients = 0;
+	for (i = 0; i < pager->model.nr_clients; i++) {
+		struct model_client *win = &pager->model.clients[i];
+		int old_desk = win->desk;
+		int rc;
 
-	if (window->desk == -1) {
-		if (!pager->show_sticky)
-			return;
+		if (!win->dirty || win->pending)
+			continue;
+		trace_begin("refetch_client", "\"window\":%lu,\"dirty\":%u",
+				(unsigned long)win->window, win->dirty);
+		rc = refetch_client(pager, win);
+		trace_end("refetch_client");
+		if (rc) {
+			/* destroyed or not shown anymore. stays dirty so
+			 * that the refresh does not reuse it. desks[]
+			 * still has it in the old bucket */
+			win->desk = old_desk;
+			pager->needs_update_properties = 1;
+			continue;
+		}
+		win->dirty = 0;
+		STAT_INC(clients_fetched);
+		model_client_changed(&pager->model, i, old_desk);
+	}
+}
 
-		for (row = 0; row < pager->rows; row++) {
-			for (col = 0; col < pager->cols; col++) {
-				x_off = col * pager->desk_w + col;
-				y_off = row * pager->desk_h + row;
+/* removes clients which could not be fetched */
+static void pager_refresh_finish(struct pager *pager)
+{
+	model_remove_pending(&pager->model);
 
-				do_draw_window(pager, window, px + x_off, py + y_off, pw, ph);
-			}
-		}
-	} else {
-		col = window->desk % pager->cols;
-		row = window->desk / pager->cols;
+	mem_free(MEM_CLIENTS, pager->refresh.queue);
+	pager->refresh.queue = NULL;
+	pager->refresh.active = 0;
 
-		x_off = col * pager->desk_w + col;
-		y_off = row * pager->desk_h + row;
+	profile_end(PROFILE_REFRESH);
+	STAT_INC(refreshes);
+	STAT_ADD(refresh_requests, NextRequest(display) - refresh_start_request);
+	STAT_HIST(refresh_time, time_us() - refresh_start_us);
 
-		do_draw_window(pager, window, px + x_off, py + y_off, pw, ph);
-	}
+	model_update_rects(&pager->model);
+	pager->model.gen++;
 }
 
-/* convert mouse coordinates (@x, @y) (which are relative to the pager window)
- * to root window coordinates (@rx, @ry) and desktop value (@desk)
- */
-static void pager_coords_to_root(struct pager *pager, int x, int y, int *rx, int *ry, int *desk)
+/* text of a window, centered in op->r */
+static void draw_text(struct pager *pager, const struct model_draw *op)
 {
-	int row, col;
+	XftColor *color;
+	XGlyphInfo extents;
+	XRectangle ra;
+	int len = strlen(op->text);
+	int x, y;
 
-	col = x / (pager->desk_w + 1);
-	row = y / (pager->desk_h + 1);
+	XftTextExtentsUtf8(display, pager->window_font, (FcChar8 *)op->text, len, &extents);
+/* 	d_print("w = %d, h = %d, x = %d, y = %d, xoff = %d, yoff = %d\n", extents.width, extents.height, extents.x, extents.y, extents.xOff, extents.yOff); */
 
-	x -= col * (pager->desk_w + 1);
-	y -= row * (pager->desk_h + 1);
+	x = op->r.x + extents.x;
+	y = op->r.y + extents.y;
+	if (extents.width < op->r.w)
+		x += (op->r.w - extents.width) / 2;
+	y += (op->r.h - extents.height) / 2;
 
-	*rx = x * pager->root_w / pager->desk_w;
-	*ry = y * pager->root_h / pager->desk_h;
-	*desk = row * pager->cols + col;
+	if (op->color == MODEL_ACTIVE_WIN) {
+		color = &pager->active_win_font_color;
+	} else {
+		color = &pager->inactive_win_font_color;
+	}
+	ra.x = op->clip.x;
+	ra.y = op->clip.y;
+	ra.width = op->clip.w;
+	ra.height = op->clip.h;
+	XftDrawSetClipRectangles(pager->xft_draw, 0, 0, &ra, 1);
+	XftDrawStringUtf8(pager->xft_draw, color,
+			pager->window_font, x, y,
+			(FcChar8 *)op->text, len);
 }
 
-static int get_window_idx(struct pager *pager, int rx, int ry, int desk)
+/* executes pager->draw on the pixmap */
+static void draw_ops(struct pager *pager)
 {
-	double scale = (double)pager->root_w / (double)pager->desk_w;
 	int i;
 
-	for (i = pager->nr_windows - 1; i >= 0; i--) {
-		struct client_window *window = &pager->windows[i];
-		int w, h, sw, sh;
+	for (i = 0; i < pager->draw.nr; i++) {
+		const struct model_draw *op = &pager->draw.ops[i];
 
-		if (!(window->desk == desk || (window->desk == -1 && pager->show_sticky)))
-			continue;
-
-		if (window->type == WINDOW_TYPE_DESKTOP)
-			continue;
+		switch (op->type) {
+		case MODEL_FILL:
+			XFillRectangle(display, pager->pixmap, pager->gc[op->color],
+					op->r.x, op->r.y, op->r.w, op->r.h);
+			break;
+		case MODEL_LINE:
+			XDrawLine(display, pager->pixmap, pager->gc[op->color],
+					op->r.x, op->r.y, op->r.x + op->r.w, op->r.y + op->r.h);
+			break;
+		case MODEL_TEXT:
+			draw_text(pager, op);
+			break;
+		}
+	}
+	pager->draw.nr = 0;
+}
 
-		if (window->states & WINDOW_STATE_HIDDEN)
-			continue;
+/* repaint single desktop cell instead of the whole pixmap */
+static void redraw_desk(struct pager *pager, int desk)
+{
+	struct model_rect cell;
 
-		h = window->h;
-		w = window->w;
-		if (window->states & WINDOW_STATE_SHADED)
-			h = WINDOW_SHADED_H;
-
-		sw = (double)w / scale;
-		sh = (double)h / scale;
-		if (sw < WINDOW_MIN_W)
-			w = (double)WINDOW_MIN_W * scale;
-		if (sh < WINDOW_MIN_H)
-			h = (double)WINDOW_MIN_H * scale;
-
-		if (rx >= window->x && rx < window->x + w &&
-		    ry >= window->y && ry < window->y + h)
-			return i;
-	}
-	return -1;
+	STAT_INC(partial_repaints);
+	model_paint_desk(&pager->model, desk, &pager->draw);
+	XftDrawChange(pager->xft_draw, pager->pixmap);
+	draw_ops(pager);
+	model_desk_rect(&pager->model, desk, &cell);
+	XClearArea(display, pager->window, cell.x, cell.y, cell.w, cell.h, False);
 }
 
 static void pager_update(struct pager *pager)
 {
-	int row, col, x, y, i;
-	int showing_desktop = 0;
-
-	pager->needs_update = 0;
-
-	/* desktops */
-	for (row = 0; row < pager->rows; row++) {
-		y = row * (pager->desk_h + 1);
-		for (col = 0; col < pager->cols; col++) {
-			x = col * (pager->desk_w + 1);
-			if (row * pager->cols + col == pager->active_desk) {
-				XFillRectangle(display, pager->pixmap,
-						pager->active_desk_gc,
-						x, y, pager->desk_w, pager->desk_h);
-			} else {
-				XFillRectangle(display, pager->pixmap,
-						pager->inactive_desk_gc,
-						x, y, pager->desk_w, pager->desk_h);
-			}
-		}
-	}
+	STAT_INC(full_repaints);
+	model_paint(&pager->model, &pager->draw);
 
-	if (pager->w_extra) {
-		XFillRectangle(display, pager->pixmap,
-				pager->inactive_desk_gc,
-				pager->w - pager->w_extra,
-				0,
-				pager->w_extra,
-				pager->h);
-	}
+	XftDrawChange(pager->xft_draw, pager->pixmap);
+	draw_ops(pager);
 
-	if (pager->h_extra) {
-		XFillRectangle(display, pager->pixmap,
-				pager->inactive_desk_gc,
-				0,
-				pager->h - pager->h_extra,
-				pager->w - pager->w_extra,
-				pager->h_extra);
-	}
+	XClearWindow(display, pager->window);
+	XFlush(display);
 
-	/* grid */
-	for (row = 1; row < pager->rows; row++) {
-		y = row * (pager->desk_h + 1) - 1;
-		XDrawLine(display, pager->pixmap, pager->grid_gc, 0, y, pager->w, y);
-	}
-	for (col = 1; col < pager->cols; col++) {
-		x = col * (pager->desk_w + 1) - 1;
-		XDrawLine(display, pager->pixmap, pager->grid_gc, x, 0, x, pager->h);
-	}
+	/* clients of the current desktop are fetched */
+	if (pager->refresh.active ? refresh_urgent_done(pager) :
+			!pager->needs_update_properties)
+		profile_first_paint();
+}
 
-	if (x_get_showing_desktop(&showing_desktop)) {
-	}
-	if (!showing_desktop) {
-		/* windows */
-		for (i = 0; i < pager->nr_windows; i++) {
-			switch (pager->windows[i].type) {
-			case WINDOW_TYPE_DESKTOP:
-			case WINDOW_TYPE_MENU:
-				break;
-			case WINDOW_TYPE_DOCK:
-			case WINDOW_TYPE_TOOLBAR:
-			case WINDOW_TYPE_UTILITY:
-			case WINDOW_TYPE_SPLASH:
-			case WINDOW_TYPE_DIALOG:
-			case WINDOW_TYPE_NORMAL:
-				if (!(pager->windows[i].states & WINDOW_STATE_HIDDEN))
-					draw_window(pager, &pager->windows[i]);
-				break;
-			}
-		}
-	}
+/* title extents are measured once per window */
+static void get_popup_extents(struct pager *pager, struct model_client *win)
+{
+	XGlyphInfo extents;
 
-	XClearWindow(display, pager->window);
-/* 	XFlush(display); */
+	if (win->has_popup_extents)
+		return;
+	XftTextExtentsUtf8(display, pager->popup_font, (FcChar8 *)win->name,
+			strlen(win->name), &extents);
+	win->popup_extents.x = extents.x;
+	win->popup_extents.y = extents.y;
+	win->popup_extents.w = extents.width;
+	win->popup_extents.h = extents.height;
+	win->has_popup_extents = 1;
 }
 
 static void pager_update_popup(struct pager *pager)
 {
+	struct model_client *win;
 	int len;
 	int x, y;
 	const char *text;
 	XRectangle ra;
 
 	pager->needs_update_popup = 0;
-	if (pager->popup_idx == -1) {
+	if (pager->model.popup_idx == -1) {
 		return;
 	}
+	STAT_INC(popup_repaints);
 
+	win = &pager->model.clients[pager->model.popup_idx];
+	get_popup_extents(pager, win);
 	ra.x = 0;
 	ra.y = 0;
-	ra.width = pager->popup_extents.width + 2 * POPUP_PAD;
-	ra.height = pager->popup_extents.height + 2 * POPUP_PAD;
+	ra.width = win->popup_extents.w + 2 * POPUP_PAD;
+	ra.height = win->popup_extents.h + 2 * POPUP_PAD;
 
-	text = pager->windows[pager->popup_idx].name;
+	text = win->name;
 	len = strlen(text);
 	XClearWindow(display, pager->popup_window);
-	x = POPUP_PAD + pager->popup_extents.x;
-	y = POPUP_PAD + pager->popup_extents.y;
+	x = POPUP_PAD + win->popup_extents.x;
+	y = POPUP_PAD + win->popup_extents.y;
 	XftDrawChange(pager->xft_draw, pager->popup_window);
 	XftDrawSetClipRectangles(pager->xft_draw, 0, 0, &ra, 1);
 	XftDrawStringUtf8(pager->xft_draw, &pager->popup_font_color, pager->popup_font,
 			x, y, (FcChar8 *)text, len);
 }
 
-static int cursor_to_desk(struct pager *pager, int x, int y)
-{
-	int row, col;
-
-	col = (x - pager->x) / (pager->desk_w + 1);
-	row = (y - pager->y) / (pager->desk_h + 1);
-	return row * pager->cols + col;
-}
-
-/* show popup window below (or above) the window in the pager */
-static void popup_show(struct pager *pager, int cx, int cy)
+/* place popup window below (or above) the window in the pager
+ * @cx:  pointer x relative to root window
+ * @row: desktop row under the pointer
+ */
+static void popup_move(struct pager *pager, int cx, int row)
 {
-	struct client_window *win;
-	int x, y, w, h, len, win_row, bw;
+	struct model_client *win;
+	int x, y, w, h, cell_y, bw;
 	int x_min = 2;
 	int y_min = 2;
-	int x_max = pager->root_w - 2;
-	int y_max = pager->root_h - 2;
+	int x_max = pager->model.root_w - 2;
+	int y_max = pager->model.root_h - 2;
 
-	if (!pager->show_popups)
-		return;
-	
-	win = &pager->windows[pager->popup_idx];
-	win_row = cursor_to_desk(pager, cx, cy) / pager->cols;
-	len = strlen(win->name);
+	win = &pager->model.clients[pager->model.popup_idx];
+	cell_y = pager->y + row * (pager->model.desk_h + 1);
 
 	bw = 1;
 
-	XftTextExtentsUtf8(display, pager->popup_font, (FcChar8 *)win->name, len, &pager->popup_extents);
-
-	w = pager->popup_extents.width + 2 * POPUP_PAD;
-	h = pager->popup_extents.y + 2 * POPUP_PAD;
+	get_popup_extents(pager, win);
+	w = win->popup_extents.w + 2 * POPUP_PAD;
+	h = win->popup_extents.y + 2 * POPUP_PAD;
 
 	x_max -= w + bw * 2;
 	y_max -= h + bw * 2;
@@ -724,27 +824,116 @@ static void popup_show(struct pager *pager, int cx, int cy)
 		x = x_max;
 
 	/* y = 4px below (or above) the window in the pager */
-	y = pager->y + win_row * pager->desk_h + win_row +
-		(win->y + win->h) * pager->desk_h / pager->root_h + 4;
+	y = cell_y + win->py + win->ph + 4;
 	if (y + h > y_max)
-		y = pager->y + win_row * pager->desk_h + win_row +
-			win->y * pager->desk_h / pager->root_h - h - 4;
+		y = cell_y + win->py - h - 4;
 	if (y < y_min)
 		y = y_min;
 	XMoveResizeWindow(display, pager->popup_window, x, y, w, h);
 
 	pager_update_popup(pager);
-	
-	XMapRaised(display, pager->popup_window);
-	pager->popup_visible = 1;
 }
 
-static void popup_hide(struct pager *pager)
+/* executes commands queued by the model and repaints damaged desktops */
+static void pager_flush(struct pager *pager)
 {
-	if (pager->popup_visible) {
-		XUnmapWindow(display, pager->popup_window);
-		pager->popup_visible = 0;
+	struct model *m = &pager->model;
+	int i;
+
+	for (i = 0; i < m->nr_cmds; i++) {
+		const struct model_cmd *cmd = &m->cmds[i];
+
+		switch (cmd->type) {
+		case MODEL_SET_DESKTOP:
+			x_set_current_desktop(cmd->desk);
+			break;
+		case MODEL_ACTIVATE:
+			x_set_active_window(cmd->window, SOURCE_INDICATION_PAGER);
+			break;
+		case MODEL_SET_WINDOW_DESKTOP:
+			x_window_set_desktop(cmd->window, cmd->desk);
+			break;
+		case MODEL_UNSHADE:
+			x_window_set_shaded(cmd->window, _NET_WM_STATE_REMOVE);
+			break;
+		case MODEL_MOVE_WINDOW:
+			x_window_set_geometry(cmd->window, XValue | YValue, cmd->x, cmd->y, 0, 0);
+			break;
+		case MODEL_POPUP_MOVE:
+			popup_move(pager, cmd->x, cmd->desk);
+			break;
+		case MODEL_POPUP_MAP:
+			XMapRaised(display, pager->popup_window);
+			break;
+		case MODEL_POPUP_UNMAP:
+			XUnmapWindow(display, pager->popup_window);
+			break;
+		}
+	}
+	m->nr_cmds = 0;
+
+	for (i = 0; i < m->nr_damage; i++)
+		redraw_desk(pager, m->damage[i]);
+	m->nr_damage = 0;
+}
+
+static int wm_running(int *wm_c, int *wm_r)
+{
+	if (x_is_netwm_compatible_wm_running())
+		return 1;
+	if (x_get_desktop_layout(wm_c, wm_r) == 0) {
+		d_print("Got desktop layout (%dx%d), NetWM compatible wm should be running\n", *wm_c, *wm_r);
+		return 1;
 	}
+	return 0;
+}
+
+/*
+ * Wait at most @timeout seconds for a NetWM compatible window manager.
+ * Root window properties are re-checked as soon as the WM sets
+ * _NET_SUPPORTING_WM_CHECK or _NET_NUMBER_OF_DESKTOPS.
+ *
+ * returns 0 if WM is running, -1 on timeout
+ */
+static int wait_for_wm(int timeout, int *wm_c, int *wm_r)
+{
+	Atom check = x_get_atom(_NET_SUPPORTING_WM_CHECK);
+	Atom nr_desks = x_get_atom(_NET_NUMBER_OF_DESKTOPS);
+	unsigned long long end;
+
+	/* must be selected before checking properties. otherwise we could
+	 * miss the PropertyNotify */
+	XSelectInput(display, DefaultRootWindow(display), PropertyChangeMask);
+	if (wm_running(wm_c, wm_r))
+		return 0;
+
+	fprintf(stderr, "NetWM compatible window manager not running. Waiting at most %d seconds.\n", timeout);
+	end = time_us() + timeout * 1000000ULL;
+	while (1) {
+		struct pollfd pfd;
+		unsigned long long now;
+
+		while (XPending(display)) {
+			XEvent e;
+
+			XNextEvent(display, &e);
+			if (e.type != PropertyNotify)
+				continue;
+			if (e.xproperty.atom != check && e.xproperty.atom != nr_desks)
+				continue;
+			if (wm_running(wm_c, wm_r))
+				return 0;
+		}
+
+		now = time_us();
+		if (now >= end)
+			break;
+		pfd.fd = ConnectionNumber(display);
+		pfd.events = POLLIN;
+		poll(&pfd, 1, (end - now + 999) / 1000);
+	}
+	fprintf(stderr, "Exiting.\n");
+	return -1;
 }
 
 /* ---------------------------------------------------------------------------
@@ -764,19 +953,20 @@ char *inactive_win_font_color = "rgb:00/00/00";
 char *popup_color = "rgb:e6/e6/e6";
 char *popup_font_color = "rgb:00/00/00";
 
-struct pager *pager_new(const char *geometry, int cols, int rows)
+/* windows, GCs and fonts. does not talk to the WM */
+static struct pager *pager_create(const char *geometry, int cols, int rows)
 {
+	unsigned long pixels[NR_MODEL_COLORS];
 	unsigned long popup_bg;
 
 	struct pager *pager;
 	XSetWindowAttributes attrib;
 	unsigned long attrib_mask;
-	int x, y;
+	int x, y, root_w, root_h, i;
 	Visual *visual;
 	Colormap cm;
 	int gflags, gx, gy;
 	unsigned int gw, gh;
-	int wm_c = -1, wm_r = -1;
 
 	x_parse_geometry(geometry, &gflags, &gx, &gy, &gw, &gh);
 	if (!(gflags & XValue))
@@ -792,58 +982,18 @@ struct pager *pager_new(const char *geometry, int cols, int rows)
 	if (gy < 0)
 		gy *= -1;
 
-	/* NetWM compatible window manager must be running */
-	while (1) {
-		static int count = 0;
-
-		if (x_is_netwm_compatible_wm_running())
-			break;
-		if (x_get_desktop_layout(&wm_c, &wm_r) == 0) {
-			d_print("Got desktop layout (%dx%d), NetWM compatible wm should be running\n", wm_c, wm_r);
-			break;
-		}
-		if (count == 0)
-			fprintf(stderr, "NetWM compatible window manager not running. Waiting at most %d seconds.\n", WM_WAIT);
-		if (count == WM_WAIT) {
-			fprintf(stderr, "Exiting.\n");
-			return NULL;
-		}
-		sleep(1);
-		count++;
-	}
-
-	if (cols == -1 || rows == -1) {
-		/* use desktop layout set by WM */
-		if (wm_c == -1 || wm_r == -1) {
-			if (x_get_desktop_layout(&wm_c, &wm_r)) {
-				fprintf(stderr, "Couldn't get desktop layout.\n");
-				return NULL;
-			}
-		}
-		cols = wm_c;
-		rows = wm_r;
-	} else {
-		/* set desktop layout */
-		if (cols > 32)
-			cols = 32;
-		if (rows > 32)
-			rows = 32;
-		if (x_set_desktop_layout(cols, rows)) {
-			fprintf(stderr, "Couldn't set desktop layout (%dx%d).\n", cols, rows);
-			return NULL;
-		}
-	}
-
 	pager = xnew(struct pager, 1);
 
-	if (x_window_get_geometry(DefaultRootWindow(display), &x, &y, &pager->root_w, &pager->root_h)) {
+	if (x_window_get_geometry(DefaultRootWindow(display), &x, &y, &root_w, &root_h)) {
 		d_print("x_window_get_geometry for root window failed\n");
 		free(pager);
 		return NULL;
 	}
 
-	pager->cols = cols;
-	pager->rows = rows;
+	model_init(&pager->model, cols, rows, root_w, root_h);
+	pager->draw.ops = NULL;
+	pager->draw.nr = 0;
+	pager->draw.alloc = 0;
 
 	d_print("g: %d,%d %d, %d %d\n", gx, gy, gw, gflags & XNegative, gflags & YNegative);
 
@@ -856,48 +1006,35 @@ struct pager *pager_new(const char *geometry, int cols, int rows)
 	pager_calc_w_h(pager);
 	pager_calc_x_y(pager);
 
-	pager->windows = NULL;
-	pager->nr_windows = 0;
-	pager->active_win = 0;
-	pager->active_desk = 0;
-
-	pager->popup_idx = -1;
-	pager->popup_visible = 0;
+	pager->refresh.queue = NULL;
+	pager->refresh.active = 0;
+	pager->confirm.deadline = 0;
 
 	pager->needs_configure = 1;
-	pager->needs_update = 1;
 	pager->needs_update_properties = 1;
 	pager->needs_update_popup = 0;
 
-	pager->show_sticky = 1;
-	pager->show_window_titles = 1;
 	pager->show_window_icons = 1;
-	pager->show_popups = 1;
 	pager->allow_cover = 1;
 
 	pager->opacity = 1.0;
 	pager->layer = LAYER_NORMAL;
 
-	pager->mouse.window_idx = -1;
-	pager->mouse.button = -1;
-	pager->mouse.dragging = 0;
-	pager->mouse.click_x = -1;
-	pager->mouse.click_y = -1;
-
 	/* main window */
 	attrib_mask = CWBackPixmap | CWBorderPixel | CWEventMask;
 	attrib.background_pixmap = ParentRelative;
 	attrib.border_pixel = 0;
 	attrib.event_mask = ButtonPressMask | ButtonReleaseMask |
 		PointerMotionMask | EnterWindowMask | LeaveWindowMask |
-		ExposureMask;
+		ExposureMask | StructureNotifyMask;
 	pager->window = XCreateWindow(display, DefaultRootWindow(display),
-			pager->x, pager->y, pager->w, pager->h,
+			pager->x, pager->y, pager->model.w, pager->model.h,
 			0, // border
 			CopyFromParent,
 			InputOutput,
 			CopyFromParent,
 			attrib_mask, &attrib);
+	replay_set_window(pager->window);
 
 	/* popup window */
 	attrib_mask = CWOverrideRedirect | CWEventMask;
@@ -912,56 +1049,163 @@ struct pager *pager_new(const char *geometry, int cols, int rows)
 			CopyFromParent,
 			attrib_mask, &attrib);
 
-	/* this is freed / recreated soon */
+	/* this is freed / recreated by first pager_configure. not counted
+	 * in MEM_PIXMAPS because pixmap_w and pixmap_h are 0 */
 	pager->pixmap = XCreatePixmap(display,
 			pager->window,
 			8,
 			8,
 			DefaultDepth(display, DefaultScreen(display)));
+	pager->pixmap_w = 0;
+	pager->pixmap_h = 0;
 
 	x_window_set_title(pager->window, "netwmpager");
 	pager_update_aspect(pager);
 
 	x_set_property(pager->window, XA_STRING,
-			XInternAtom(display, "WM_CLASS", False),
+			XA_WM_CLASS,
 			8, "netwmpager\0netwmpager", 22);
 
-	pager->active_win_gc    = make_gc(pager->window, active_win_color);
-	pager->inactive_win_gc  = make_gc(pager->window, inactive_win_color);
-	pager->active_desk_gc   = make_gc(pager->window, active_desk_color);
-	pager->inactive_desk_gc = make_gc(pager->window, inactive_desk_color);
-	pager->win_border_gc    = make_gc(pager->window, win_border_color);
-	pager->grid_gc          = make_gc(pager->window, grid_color);
+	profile_begin(PROFILE_COLORS);
+	x_parse_color(active_win_color, &pixels[MODEL_ACTIVE_WIN]);
+	x_parse_color(inactive_win_color, &pixels[MODEL_INACTIVE_WIN]);
+	x_parse_color(active_desk_color, &pixels[MODEL_ACTIVE_DESK]);
+	x_parse_color(inactive_desk_color, &pixels[MODEL_INACTIVE_DESK]);
+	x_parse_color(win_border_color, &pixels[MODEL_WIN_BORDER]);
+	x_parse_color(grid_color, &pixels[MODEL_GRID]);
+	x_parse_color(popup_color, &popup_bg);
+	profile_end(PROFILE_COLORS);
+
+	profile_begin(PROFILE_GCS);
+	for (i = 0; i < NR_MODEL_COLORS; i++)
+		pager->gc[i] = make_gc(pager->window, pixels[i]);
+	profile_end(PROFILE_GCS);
 
+	profile_begin(PROFILE_XFT_COLORS);
 	visual = DefaultVisual(display, DefaultScreen(display));
 	cm = DefaultColormap(display, DefaultScreen(display));
 	pager->xft_draw = XftDrawCreate(display, pager->pixmap, visual, cm);
 	XftColorAllocName(display, visual, cm, active_win_font_color, &pager->active_win_font_color);
 	XftColorAllocName(display, visual, cm, inactive_win_font_color, &pager->inactive_win_font_color);
 	XftColorAllocName(display, visual, cm, popup_font_color, &pager->popup_font_color);
+	profile_end(PROFILE_XFT_COLORS);
 
-	x_parse_color(popup_color, &popup_bg);
 	XSetWindowBackground(display, pager->popup_window, popup_bg);
 
 	pager->window_font = NULL;
 	pager->popup_font = NULL;
 	pager_set_window_font(pager, "fixed");
 	pager_set_popup_font(pager, "fixed");
+	return pager;
+}
+
+struct pager *pager_new(const char *geometry, int cols, int rows, int wm_wait)
+{
+	struct pager *pager;
+	int wm_c = -1, wm_r = -1;
+	int rc;
+
+	/* NetWM compatible window manager must be running */
+	profile_begin(PROFILE_WM_WAIT);
+	rc = wait_for_wm(wm_wait, &wm_c, &wm_r);
+	profile_end(PROFILE_WM_WAIT);
+	if (rc)
+		return NULL;
+
+	if (cols == -1 || rows == -1) {
+		/* use desktop layout set by WM */
+		if (wm_c == -1 || wm_r == -1) {
+			if (x_get_desktop_layout(&wm_c, &wm_r)) {
+				fprintf(stderr, "Couldn't get desktop layout.\n");
+				return NULL;
+			}
+		}
+		cols = wm_c;
+		rows = wm_r;
+	} else {
+		/* set desktop layout */
+		if (cols > 32)
+			cols = 32;
+		if (rows > 32)
+			rows = 32;
+		if (x_set_desktop_layout(cols, rows)) {
+			fprintf(stderr, "Couldn't set desktop layout (%dx%d).\n", cols, rows);
+			return NULL;
+		}
+	}
 
-	XSelectInput(display, DefaultRootWindow(display), PropertyChangeMask | SubstructureNotifyMask);
+	pager = pager_create(geometry, cols, rows);
+	if (pager == NULL)
+		return NULL;
+
+	/* membership and stacking come from the EWMH root properties,
+	 * geometry from ConfigureNotify of the clients */
+	XSelectInput(display, DefaultRootWindow(display), PropertyChangeMask);
+	read_root_state(pager, None);
 	return pager;
 }
 
+struct pager *pager_new_offscreen(const char *geometry, int cols, int rows)
+{
+	struct pager *pager = pager_create(geometry, cols, rows);
+
+	if (pager)
+		pager->needs_update_properties = 0;
+	return pager;
+}
+
+void pager_set_clients(struct pager *pager, const struct pager_client *clients, int nr)
+{
+	struct model_client *windows = mem_new0(MEM_CLIENTS, struct model_client, nr);
+	int i;
+
+	for (i = 0; i < nr; i++) {
+		struct model_client *win = &windows[i];
+
+		win->window = clients[i].window;
+		win->x = clients[i].x;
+		win->y = clients[i].y;
+		win->w = clients[i].w;
+		win->h = clients[i].h;
+		win->desk = clients[i].desk;
+		win->type = clients[i].type;
+		win->states = clients[i].states;
+		win->name = mem_strdup(MEM_TITLES, clients[i].name);
+		win->icon_w = -1;
+		win->icon_h = -1;
+	}
+	model_replace_clients(&pager->model, windows, nr);
+	pager->model.popup_idx = -1;
+	pager->model.mouse.window_idx = -1;
+	model_update_rects(&pager->model);
+	pager->model.gen++;
+}
+
+void pager_set_active(struct pager *pager, int desk, Window window)
+{
+	pager->model.active_desk = desk;
+	pager->model.active_win = window;
+	pager->model.gen++;
+}
+
+void pager_render(struct pager *pager)
+{
+	if (pager->needs_configure)
+		pager_configure(pager);
+	pager_update(pager);
+}
+
 void pager_delete(struct pager *pager)
 {
+	int i;
+
 	XFreePixmap(display, pager->pixmap);
+#if DEBUG > 0
+	MEM_ADD(MEM_PIXMAPS, -pixmap_bytes(pager->pixmap_w, pager->pixmap_h));
+#endif
 
-	XFreeGC(display, pager->active_win_gc);
-	XFreeGC(display, pager->inactive_win_gc);
-	XFreeGC(display, pager->active_desk_gc);
-	XFreeGC(display, pager->inactive_desk_gc);
-	XFreeGC(display, pager->win_border_gc);
-	XFreeGC(display, pager->grid_gc);
+	for (i = 0; i < NR_MODEL_COLORS; i++)
+		XFreeGC(display, pager->gc[i]);
 
 	XftFontClose(display, pager->window_font);
 	XftFontClose(display, pager->popup_font);
@@ -972,40 +1216,164 @@ void pager_delete(struct pager *pager)
 
 	XDestroyWindow(display, pager->window);
 
-	pager_free_windows(pager);
+	mem_free(MEM_CLIENTS, pager->refresh.queue);
+	model_free(&pager->model);
+	model_draw_list_free(&pager->draw);
 	free(pager);
 }
 
 void pager_expose_event(struct pager *pager, XEvent *event)
 {
+	/* more Expose events for this window follow */
+	if (event->xexpose.count)
+		return;
 	if (event->xexpose.window == pager->window) {
-		pager->needs_update = 1;
+		/* server has already repainted the exposed area from the
+		 * background pixmap. if the pixmap is stale pager_update
+		 * redraws it and clears the whole window anyway */
+		d_print("expose %dx%d+%d+%d, pixmap %s\n",
+				event->xexpose.width, event->xexpose.height,
+				event->xexpose.x, event->xexpose.y,
+				pager->model.painted_gen == pager->model.gen ? "up to date" : "stale");
 	} else {
 		pager->needs_update_popup = 1;
 	}
 }
 
-void pager_configure_notify(struct pager *pager)
+void pager_configure_notify(struct pager *pager, const XConfigureEvent *event)
 {
-	pager->needs_configure = 1;
-	pager->needs_update_properties = 1;
+	if (event->window == pager->window) {
+		pager->needs_configure = 1;
+		return;
+	}
+	pager_dirty_client(pager, event->window, MODEL_DIRTY_GEOMETRY);
 }
 
-void pager_property_notify(struct pager *pager)
+/* client properties read by fetch_client(). returns MODEL_DIRTY_* for
+ * @atom or 0 */
+static unsigned int client_atom_dirty(Atom atom)
 {
-	pager->needs_update_properties = 1;
+	static const struct {
+		enum atom_index atom;
+		unsigned int dirty;
+	} atoms[] = {
+		{ _NET_WM_DESKTOP,	MODEL_DIRTY_DESK },
+		{ _NET_WM_STATE,	MODEL_DIRTY_STATES },
+		{ _NET_WM_WINDOW_TYPE,	MODEL_DIRTY_TYPE },
+		{ _NET_WM_VISIBLE_NAME,	MODEL_DIRTY_TITLE },
+		{ _NET_WM_NAME,		MODEL_DIRTY_TITLE },
+		{ WM_NAME,		MODEL_DIRTY_TITLE }
+	};
+	int i;
+
+	for (i = 0; i < sizeof(atoms) / sizeof(atoms[0]); i++) {
+		if (atom == x_get_atom(atoms[i].atom))
+			return atoms[i].dirty;
+	}
+	return 0;
 }
 
-void pager_handle_events(struct pager *pager)
+void pager_property_notify(struct pager *pager, const XPropertyEvent *event)
 {
-	if (pager->needs_configure)
+	Window window = event->window;
+	Atom atom = event->atom;
+
+	/* we already know what we wrote */
+	if (x_is_own_property_change(event))
+		return;
+	if (window != DefaultRootWindow(display)) {
+		unsigned int dirty = client_atom_dirty(atom);
+
+		if (dirty)
+			pager_dirty_client(pager, window, dirty);
+		return;
+	}
+	if (atom == x_get_atom(_NET_SHOWING_DESKTOP) ||
+			atom == x_get_atom(_NET_CURRENT_DESKTOP) ||
+			atom == x_get_atom(_NET_ACTIVE_WINDOW)) {
+		read_root_state(pager, atom);
+		return;
+	}
+	if (atom == x_get_atom(_NET_NUMBER_OF_DESKTOPS) ||
+			atom == x_get_atom(_NET_DESKTOP_LAYOUT)) {
+		read_root_state(pager, atom);
+		/* desktops of clients may change too */
+		pager->needs_update_properties = 1;
+		return;
+	}
+	/* client list or stacking order changed */
+	if (atom == x_get_atom(_NET_CLIENT_LIST_STACKING) ||
+			atom == x_get_atom(_NET_CLIENT_LIST))
+		pager->needs_update_properties = 1;
+}
+
+int pager_needs_work(struct pager *pager)
+{
+	return pager->needs_configure ||
+		pager->needs_update_properties ||
+		pager->needs_update_clients ||
+		pager->needs_update_popup ||
+		pager->refresh.active ||
+		pager->model.painted_gen != pager->model.gen ||
+		pager->model.nr_damage ||
+		confirm_expired(pager);
+}
+
+int pager_timeout(struct pager *pager)
+{
+	unsigned long long now;
+
+	if (!pager->confirm.deadline)
+		return -1;
+	now = time_us();
+	if (now >= pager->confirm.deadline)
+		return 0;
+	return (pager->confirm.deadline - now + 999) / 1000;
+}
+
+int pager_handle_events(struct pager *pager)
+{
+	if (pager->needs_configure) {
+		trace_begin("pager_configure", NULL);
 		pager_configure(pager);
-	if (pager->needs_update_properties)
-		pager_update_properties(pager);
-	if (pager->needs_update)
+		trace_end("pager_configure");
+	}
+	if (!pager->refresh.active && pager->needs_update_properties) {
+		trace_begin("pager_refresh_start", NULL);
+		pager_refresh_start(pager);
+		trace_end("pager_refresh_start");
+	}
+	if (pager->refresh.active) {
+		trace_begin("pager_refresh_step", "\"fetched\":%d,\"queued\":%d",
+				pager->refresh.fetched, pager->refresh.nr_queue);
+		if (pager_refresh_step(pager))
+			pager_refresh_finish(pager);
+		trace_end("pager_refresh_step");
+	}
+	if (pager->needs_update_clients) {
+		trace_begin("pager_update_clients", NULL);
+		pager_update_clients(pager);
+		trace_end("pager_update_clients");
+	}
+	/* a half fetched current desktop is not worth a paint */
+	if (pager->model.painted_gen != pager->model.gen &&
+			(!pager->refresh.active || refresh_urgent_done(pager))) {
+		trace_begin("pager_update", NULL);
 		pager_update(pager);
-	if (pager->needs_update_popup)
+		trace_end("pager_update");
+	}
+	if (confirm_expired(pager))
+		confirm_timeout(pager);
+	/* cells damaged by root state changes */
+	if (pager->model.nr_damage)
+		pager_flush(pager);
+	if (pager->needs_update_popup) {
+		trace_begin("pager_update_popup", NULL);
 		pager_update_popup(pager);
+		trace_end("pager_update_popup");
+	}
+	return pager->needs_configure || pager->needs_update_properties ||
+		pager->refresh.active;
 }
 
 void pager_set_opacity(struct pager *pager, double opacity)
@@ -1023,7 +1391,9 @@ static int set_font(const char *name, XftFont **font)
 {
 	XftFont *f;
 
+	profile_begin(PROFILE_FONTS);
 	f = XftFontOpenName(display, DefaultScreen(display), name);
+	profile_end(PROFILE_FONTS);
 	if (f == NULL)
 		return -1;
 	if (*font)
@@ -1048,12 +1418,12 @@ int pager_set_popup_font(struct pager *pager, const char *name)
 
 void pager_set_show_sticky(struct pager *pager, int on)
 {
-	pager->show_sticky = on != 0;
+	pager->model.show_sticky = on != 0;
 }
 
 void pager_set_show_window_titles(struct pager *pager, int on)
 {
-	pager->show_window_titles = on != 0;
+	pager->model.show_window_titles = on != 0;
 }
 
 void pager_set_show_window_icons(struct pager *pager, int on)
@@ -1063,7 +1433,7 @@ void pager_set_show_window_icons(struct pager *pager, int on)
 
 void pager_set_show_popups(struct pager *pager, int on)
 {
-	pager->show_popups = on != 0;
+	pager->model.show_popups = on != 0;
 }
 
 void pager_set_allow_cover(struct pager *pager, int on)
@@ -1098,127 +1468,59 @@ void pager_show(struct pager *pager)
 	x_window_set_desktop(pager->window, -1);
 }
 
-void pager_button_press(struct pager *pager, int x, int y, int button)
+/* feeds one input event to the model */
+static void pager_input(struct pager *pager, enum model_event_type type,
+		int x, int y, int x_root, int y_root, int button)
 {
-	int rx, ry, desk;
-
-	if (pager->popup_visible)
-		popup_hide(pager);
-	if (button != 1 && button != 2)
-		return;
-	if (pager->mouse.button != -1)
-		return;
-
-	pager->mouse.button = button;
-	pager->mouse.dragging = 0;
-	pager->mouse.click_x = x;
-	pager->mouse.click_y = y;
-
-	pager_coords_to_root(pager, x, y, &rx, &ry, &desk);
-
-	pager->mouse.window_idx = get_window_idx(pager, rx, ry, desk);
-	if (pager->mouse.window_idx != -1) {
-		pager->mouse.window_x = rx - pager->windows[pager->mouse.window_idx].x;
-		pager->mouse.window_y = ry - pager->windows[pager->mouse.window_idx].y;
+	struct model_event e;
+	int desk = pager->model.active_desk;
+	Window win = pager->model.active_win;
+
+	e.type = type;
+	e.x = x;
+	e.y = y;
+	e.x_root = x_root;
+	e.y_root = y_root;
+	e.button = button;
+	model_handle_event(&pager->model, &e);
+
+	/* shown before the WM confirms. a replay must not depend on timing */
+	if ((desk != pager->model.active_desk || win != pager->model.active_win) &&
+			replay_mode != REPLAY_PLAY) {
+		if (!pager->confirm.deadline) {
+			pager->confirm.desk = desk;
+			pager->confirm.win = win;
+		}
+		if (desk != pager->model.active_desk)
+			pager->confirm.desk_pending = 1;
+		if (win != pager->model.active_win)
+			pager->confirm.win_pending = 1;
+		pager->confirm.deadline = time_us() + CONFIRM_TIMEOUT_US;
 	}
+	pager_flush(pager);
+}
 
+void pager_button_press(struct pager *pager, int x, int y, int button)
+{
+	pager_input(pager, MODEL_BUTTON_PRESS, x, y, 0, 0, button);
 }
 
 void pager_button_release(struct pager *pager, int x, int y, int button)
 {
-	int rx, ry, desk;
-
-	if (pager->mouse.button != button)
-		return;
-
-	pager_coords_to_root(pager, x, y, &rx, &ry, &desk);
-
-	if (button == 1) {
-		if (pager->mouse.window_idx == -1) {
-			x_set_current_desktop(desk);
-		} else if (!pager->mouse.dragging) {
-			x_set_current_desktop(desk);
-			x_set_active_window(pager->windows[pager->mouse.window_idx].window, SOURCE_INDICATION_PAGER);
-		}
-	} else if (button == 2) {
-	}
-
-	pager->mouse.window_idx = -1;
-	pager->mouse.button = -1;
-	pager->mouse.dragging = 0;
+	pager_input(pager, MODEL_BUTTON_RELEASE, x, y, 0, 0, button);
 }
 
-void pager_motion(struct pager *pager, int x, int y)
+void pager_motion(struct pager *pager, int x, int y, int x_root, int y_root)
 {
-	int rx, ry, desk;
-	struct client_window *window;
-
-	if (pager->mouse.button == -1) {
-		/* show / hide popup */
-		int idx;
-		int cx, cy;
-		Window child_ret;
-
-		if (!XTranslateCoordinates(display, pager->window,
-					DefaultRootWindow(display),
-					x, y, &cx, &cy, &child_ret)) {
-			fprintf(stderr, "XTranslateCoordinates failed\n");
-			return;
-		}
-		pager_coords_to_root(pager, x, y, &rx, &ry, &desk);
-		idx = get_window_idx(pager, rx, ry, desk);
-		if (pager->popup_visible) {
-			if (idx == -1) {
-				popup_hide(pager);
-			} else if (idx != pager->popup_idx) {
-				popup_hide(pager);
-				pager->popup_idx = idx;
-				popup_show(pager, cx, cy);
-			}
-		} else if (idx != -1) {
-			pager->popup_idx = idx;
-			popup_show(pager, cx, cy);
-		}
-	} else if (pager->mouse.window_idx != -1) {
-		if (!pager->mouse.dragging &&
-				abs(pager->mouse.click_x - x) < DRAG_THRESHOLD &&
-				abs(pager->mouse.click_y - y) < DRAG_THRESHOLD)
-			return;
-
-		/* move window */
-		pager->mouse.dragging = 1;
-
-		pager_coords_to_root(pager, x, y, &rx, &ry, &desk);
-		window = &pager->windows[pager->mouse.window_idx];
-		if (desk != window->desk && window->desk != -1) {
-			x_window_set_desktop(window->window, desk);
-			window->desk = desk;
-		}
-		if (pager->mouse.button == 1) {
-			/* move to other desk (already done :)) */
-		} else if (pager->mouse.button == 2) {
-			/* exact placement */
-			int wx, wy;
-
-			/* can't set geometry of a shaded window */
-			if (window->states & WINDOW_STATE_SHADED)
-				x_window_set_shaded(window->window, _NET_WM_STATE_REMOVE);
-
-			wx = rx - pager->mouse.window_x;
-			wy = ry - pager->mouse.window_y;
-			x_window_set_geometry(window->window, XValue | YValue, wx, wy, 0, 0);
-			window->x = wx;
-			window->y = wy;
-		}
-	}
+	pager_input(pager, MODEL_MOTION, x, y, x_root, y_root, 0);
 }
 
-void pager_enter(struct pager *pager, int x, int y)
+void pager_enter(struct pager *pager, int x, int y, int x_root, int y_root)
 {
-	pager_motion(pager, x, y);
+	pager_motion(pager, x, y, x_root, y_root);
 }
 
 void pager_leave(struct pager *pager)
 {
-	popup_hide(pager);
+	pager_input(pager, MODEL_LEAVE, 0, 0, 0, 0, 0);
 }
@@ -47,17 +47,24 @@ extern char *inactive_win_font_color;
 extern char *popup_color;
 extern char *popup_font_color;
 
-/* extern struct pager *pager_new(const char *geometry, int wait_wm); */
-extern struct pager *pager_new(const char *geometry, int cols, int rows);
+/* @wm_wait: max number of seconds to wait for NetWM compatible WM */
+extern struct pager *pager_new(const char *geometry, int cols, int rows, int wm_wait);
 extern void pager_delete(struct pager *pager);
 
 /* events */
 extern void pager_expose_event(struct pager *pager, XEvent *event);
-extern void pager_configure_notify(struct pager *pager);
-extern void pager_property_notify(struct pager *pager);
+extern void pager_configure_notify(struct pager *pager, const XConfigureEvent *event);
+extern void pager_property_notify(struct pager *pager, const XPropertyEvent *event);
 
-/* flush events (see above) */
-extern void pager_handle_events(struct pager *pager);
+/* returns 1 if pager_handle_events() has something to do */
+extern int pager_needs_work(struct pager *pager);
+/* milliseconds until pager_needs_work() becomes true without any event,
+ * -1 if never */
+extern int pager_timeout(struct pager *pager);
+
+/* flush events (see above). does a bounded amount of work and returns 1
+ * if it should be called again */
+extern int pager_handle_events(struct pager *pager);
 
 /* options */
 extern void pager_set_opacity(struct pager *pager, double opacity);
@@ -72,10 +79,32 @@ extern void pager_set_allow_cover(struct pager *pager, int on);
 
 extern void pager_show(struct pager *pager);
 
+/*
+ * Model seam for bench/render.c. The pager is created without a window
+ * manager and the client table is filled directly.
+ */
+struct pager_client {
+	Window window;
+	int x, y, w, h;
+	/* -1 = sticky */
+	int desk;
+	enum window_type type;
+	/* WINDOW_STATE_* */
+	unsigned int states;
+	const char *name;
+};
+
+extern struct pager *pager_new_offscreen(const char *geometry, int cols, int rows);
+extern void pager_set_clients(struct pager *pager, const struct pager_client *clients, int nr);
+extern void pager_set_active(struct pager *pager, int desk, Window window);
+/* redraws the whole pixmap */
+extern void pager_render(struct pager *pager);
+
 extern void pager_button_press(struct pager *pager, int x, int y, int button);
 extern void pager_button_release(struct pager *pager, int x, int y, int button);
-extern void pager_motion(struct pager *pager, int x, int y);
-extern void pager_enter(struct pager *pager, int x, int y);
+/* @x_root, @y_root: pointer position relative to the root window */
+extern void pager_motion(struct pager *pager, int x, int y, int x_root, int y_root);
+extern void pager_enter(struct pager *pager, int x, int y, int x_root, int y_root);
 extern void pager_leave(struct pager *pager);
 
 #endif
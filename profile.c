@@ -0,0 +1,111 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include <profile.h>
+#include <hist.h>
+
+struct phase {
+	const char *name;
+	unsigned long long begin;
+	unsigned long long us;
+	/* end of the last call, relative to start */
+	unsigned long long end;
+	unsigned int calls;
+};
+
+static struct phase phases[NR_PROFILE_PHASES] = {
+	{ "load_config" },
+	{ "x_init" },
+	{ "wm wait" },
+	{ "colors" },
+	{ "GCs" },
+	{ "Xft colors" },
+	{ "fonts" },
+	{ "pager_show" },
+	{ "first refresh" }
+};
+
+static unsigned long long start;
+/* relative to start, 0 = not painted yet */
+static unsigned long long first_paint;
+static int done = 0;
+
+void profile_start(void)
+{
+	start = time_us();
+}
+
+void profile_begin(enum profile_phase phase)
+{
+	if (done)
+		return;
+	phases[phase].begin = time_us();
+}
+
+void profile_end(enum profile_phase phase)
+{
+	struct phase *p = &phases[phase];
+	unsigned long long now;
+
+	if (done || p->begin == 0)
+		return;
+	/* only the first refresh */
+	if (phase == PROFILE_REFRESH && p->calls)
+		return;
+	now = time_us();
+	p->us += now - p->begin;
+	p->end = now - start;
+	p->begin = 0;
+	p->calls++;
+	if (first_paint && phases[PROFILE_REFRESH].calls)
+		done = 1;
+}
+
+void profile_first_paint(void)
+{
+	if (done || first_paint)
+		return;
+	first_paint = time_us() - start;
+	if (first_paint == 0)
+		first_paint = 1;
+	if (phases[PROFILE_REFRESH].calls)
+		done = 1;
+}
+
+int profile_done(void)
+{
+	return done;
+}
+
+void profile_print(FILE *f)
+{
+	unsigned long long sum = 0;
+	int i;
+
+	fprintf(f, "startup profile        calls        ms    end at ms\n");
+	for (i = 0; i < NR_PROFILE_PHASES; i++) {
+		const struct phase *p = &phases[i];
+
+		fprintf(f, "  %-20s %5u %9.3f %12.3f\n", p->name, p->calls,
+				p->us / 1000.0, p->end / 1000.0);
+		/* refresh runs between paints and input handling */
+		if (i != PROFILE_REFRESH)
+			sum += p->us;
+	}
+	fprintf(f, "  %-20s       %9.3f\n", "other until paint", first_paint > sum ? (first_paint - sum) / 1000.0 : 0.0);
+	fprintf(f, "time to first paint: %.3f ms\n", first_paint / 1000.0);
+}
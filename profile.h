@@ -0,0 +1,60 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+#include <stdio.h>
+
+/*
+ * Startup profile, see -profile-startup. Phases are timed from the start
+ * of main() until the first paint which shows the clients of the current
+ * desktop and the end of the first client refresh. Recording costs a few
+ * clock_gettime() calls so it is always on, later calls are ignored.
+ */
+
+enum profile_phase {
+	PROFILE_CONFIG,
+	PROFILE_X_INIT,
+	PROFILE_WM_WAIT,
+	/* named colors of the GCs and the popup background */
+	PROFILE_COLORS,
+	PROFILE_GCS,
+	PROFILE_XFT_COLORS,
+	/* every XftFontOpenName, default and configured fonts */
+	PROFILE_FONTS,
+	PROFILE_SHOW,
+	/* from the first pager_refresh_start() to its pager_refresh_finish() */
+	PROFILE_REFRESH,
+	NR_PROFILE_PHASES
+};
+
+/* call first thing in main() */
+extern void profile_start(void);
+
+extern void profile_begin(enum profile_phase phase);
+extern void profile_end(enum profile_phase phase);
+
+/* first paint with the clients of the current desktop */
+extern void profile_first_paint(void);
+
+/* returns 1 when first paint and first refresh are both done */
+extern int profile_done(void);
+
+extern void profile_print(FILE *f);
+
+#endif
@@ -0,0 +1,642 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include <replay.h>
+#include <x.h>
+#include <hist.h>
+#include <xmalloc.h>
+#include <debug.h>
+
+#include <X11/Xlib.h>
+#include <X11/Xatom.h>
+#include <stdio.h>
+#include <string.h>
+
+#define REPLAY_MAGIC "NWPREC1\n"
+
+/* record kinds */
+enum {
+	REC_BATCH,
+	REC_WINDOW,
+	REC_PROPERTY,
+	REC_GEOMETRY,
+	REC_OWN_CHANGE
+};
+
+/* REC_BATCH: u32 nr, then nr times u8 size + first size bytes of XEvent */
+
+/* followed by @nr elements of @format bits */
+struct rec_property {
+	Window window;
+	Atom type;
+	Atom property;
+	int rc;
+	int nr;
+	int format;
+};
+
+struct rec_geometry {
+	Window window;
+	int rc;
+	int x, y, w, h;
+};
+
+struct rec_own_change {
+	Window window;
+	Atom atom;
+	unsigned long serial;
+};
+
+/* recorded reply */
+struct reply {
+	struct reply *next;
+	/* number of batches read before this was recorded */
+	int seq;
+	int kind;
+	/* key */
+	Window window;
+	Atom atom;
+	Atom type;
+	/* struct rec_* */
+	char *payload;
+	unsigned int len;
+};
+
+struct batch {
+	XEvent *events;
+	int nr;
+};
+
+enum replay_mode replay_mode = REPLAY_OFF;
+
+static FILE *replay_fp = NULL;
+
+/* ids on the recorded server */
+static Window rec_root;
+static Window rec_window = None;
+static Atom rec_atoms[NR_ATOMS];
+
+/* the pager window on this server */
+static Window live_window = None;
+
+static struct batch *batches = NULL;
+static int nr_batches = 0;
+/* batches returned by replay_read_batch() */
+static int cur_seq = 0;
+
+/* hash table of replies, chains are in recording order */
+static struct reply **replies = NULL;
+static unsigned int replies_size = 0;
+static unsigned long nr_replies = 0;
+
+static unsigned long nr_events = 0;
+static unsigned long nr_misses = 0;
+static unsigned long long start_time;
+
+static void write_record(int kind, const void *a, unsigned int a_len, const void *b, unsigned int b_len)
+{
+	unsigned char k = kind;
+	unsigned int len = a_len + b_len;
+
+	fwrite(&k, 1, 1, replay_fp);
+	fwrite(&len, sizeof(len), 1, replay_fp);
+	fwrite(a, 1, a_len, replay_fp);
+	if (b_len)
+		fwrite(b, 1, b_len, replay_fp);
+}
+
+/* returns 0 on success, 1 at end of file, -1 on error */
+static int read_record(int *kind, char **payload, unsigned int *len)
+{
+	unsigned char k;
+
+	if (fread(&k, 1, 1, replay_fp) != 1)
+		return 1;
+	if (fread(len, sizeof(*len), 1, replay_fp) != 1)
+		return -1;
+	*kind = k;
+	*payload = xmalloc(*len ? *len : 1);
+	if (fread(*payload, 1, *len, replay_fp) != *len) {
+		free(*payload);
+		return -1;
+	}
+	return 0;
+}
+
+/* only the part of the event the pager uses is saved */
+static int event_size(int type)
+{
+	switch (type) {
+	case ButtonPress:
+	case ButtonRelease:
+		return sizeof(XButtonEvent);
+	case MotionNotify:
+		return sizeof(XMotionEvent);
+	case EnterNotify:
+	case LeaveNotify:
+		return sizeof(XCrossingEvent);
+	case Expose:
+		return sizeof(XExposeEvent);
+	case ConfigureNotify:
+		return sizeof(XConfigureEvent);
+	case PropertyNotify:
+		return sizeof(XPropertyEvent);
+	case ClientMessage:
+		return sizeof(XClientMessageEvent);
+	}
+	return sizeof(XAnyEvent);
+}
+
+static int property_size(int format, int nr)
+{
+	switch (format) {
+	case 32:
+		/* XGetWindowProperty returns longs */
+		return nr * sizeof(long);
+	case 16:
+		return nr * sizeof(short);
+	}
+	return nr;
+}
+
+/* recorded -> live */
+static Atom live_atom(Atom atom)
+{
+	int i;
+
+	for (i = 0; i < NR_ATOMS; i++) {
+		if (rec_atoms[i] == atom)
+			return x_get_atom(i);
+	}
+	return atom;
+}
+
+static Window live_win(Window window)
+{
+	if (window == rec_root)
+		return DefaultRootWindow(display);
+	if (window == rec_window && window != None)
+		return live_window;
+	return window;
+}
+
+/* live -> recorded */
+static Atom recorded_atom(Atom atom)
+{
+	int i;
+
+	for (i = 0; i < NR_ATOMS; i++) {
+		if (x_get_atom(i) == atom)
+			return rec_atoms[i];
+	}
+	return atom;
+}
+
+static Window recorded_win(Window window)
+{
+	if (window == DefaultRootWindow(display))
+		return rec_root;
+	return window;
+}
+
+/* -- recording -- */
+
+int replay_record_open(const char *filename)
+{
+	unsigned int long_size = sizeof(long);
+	unsigned int nr_atoms = NR_ATOMS;
+	Window root = DefaultRootWindow(display);
+	Atom atoms[NR_ATOMS];
+	int i;
+
+	replay_fp = fopen(filename, "w");
+	if (replay_fp == NULL)
+		return -1;
+	for (i = 0; i < NR_ATOMS; i++)
+		atoms[i] = x_get_atom(i);
+	fwrite(REPLAY_MAGIC, 1, 8, replay_fp);
+	fwrite(&long_size, sizeof(long_size), 1, replay_fp);
+	fwrite(&root, sizeof(root), 1, replay_fp);
+	fwrite(&nr_atoms, sizeof(nr_atoms), 1, replay_fp);
+	fwrite(atoms, sizeof(Atom), NR_ATOMS, replay_fp);
+	replay_mode = REPLAY_RECORD;
+	return 0;
+}
+
+void replay_record_batch(const XEvent *events, int nr)
+{
+	char *buf = xnew(char, sizeof(unsigned int) + nr * (1 + sizeof(XEvent)));
+	unsigned int n = nr;
+	char *p = buf;
+	int i;
+
+	memcpy(p, &n, sizeof(n));
+	p += sizeof(n);
+	for (i = 0; i < nr; i++) {
+		int size = event_size(events[i].type);
+
+		*p++ = size;
+		memcpy(p, &events[i], size);
+		p += size;
+	}
+	write_record(REC_BATCH, buf, p - buf, NULL, 0);
+	free(buf);
+	/* the pager is usually killed */
+	fflush(replay_fp);
+}
+
+void replay_record_property(Window window, Atom type, Atom property, int rc,
+		const char *data, int nr, int format)
+{
+	struct rec_property r;
+
+	r.window = window;
+	r.type = type;
+	r.property = property;
+	r.rc = rc;
+	r.nr = rc ? 0 : nr;
+	r.format = format;
+	write_record(REC_PROPERTY, &r, sizeof(r), data, property_size(format, r.nr));
+}
+
+void replay_record_geometry(Window window, int rc, int x, int y, int w, int h)
+{
+	struct rec_geometry r;
+
+	r.window = window;
+	r.rc = rc;
+	r.x = x;
+	r.y = y;
+	r.w = w;
+	r.h = h;
+	write_record(REC_GEOMETRY, &r, sizeof(r), NULL, 0);
+}
+
+void replay_record_own_change(const XPropertyEvent *event)
+{
+	struct rec_own_change r;
+
+	r.window = event->window;
+	r.atom = event->atom;
+	r.serial = event->serial;
+	write_record(REC_OWN_CHANGE, &r, sizeof(r), NULL, 0);
+}
+
+void replay_set_window(Window window)
+{
+	if (replay_mode == REPLAY_RECORD)
+		write_record(REC_WINDOW, &window, sizeof(window), NULL, 0);
+	live_window = window;
+}
+
+int replay_is_live_window(Window window)
+{
+	return window == live_window;
+}
+
+/* -- replay -- */
+
+static unsigned int reply_hash(int kind, Window window, Atom atom, Atom type)
+{
+	unsigned long h = (window * 31 + atom) * 31 + type + kind;
+
+	return (h ^ (h >> 9)) & (replies_size - 1);
+}
+
+static int load_batch(const char *payload, unsigned int len)
+{
+	struct batch *b;
+	unsigned int n, i;
+	const char *p = payload + sizeof(n);
+
+	if (len < sizeof(n))
+		return -1;
+	memcpy(&n, payload, sizeof(n));
+	batches = xrenew(struct batch, batches, nr_batches + 1);
+	b = &batches[nr_batches++];
+	b->events = xnew0(XEvent, n);
+	b->nr = n;
+	for (i = 0; i < n; i++) {
+		unsigned int size;
+
+		if (p >= payload + len)
+			return -1;
+		size = (unsigned char)*p++;
+		if (size > sizeof(XEvent) || p + size > payload + len)
+			return -1;
+		memcpy(&b->events[i], p, size);
+		p += size;
+	}
+	return 0;
+}
+
+static struct reply *new_reply(int kind, char *payload, unsigned int len)
+{
+	struct reply *r = xnew(struct reply, 1);
+
+	r->seq = nr_batches;
+	r->kind = kind;
+	r->atom = None;
+	r->type = None;
+	r->payload = payload;
+	r->len = len;
+	if (kind == REC_PROPERTY) {
+		const struct rec_property *p = (const struct rec_property *)payload;
+
+		if (len < sizeof(*p) || len - sizeof(*p) != property_size(p->format, p->nr))
+			goto err;
+		r->window = p->window;
+		r->atom = p->property;
+		r->type = p->type;
+	} else if (kind == REC_GEOMETRY) {
+		if (len != sizeof(struct rec_geometry))
+			goto err;
+		r->window = ((const struct rec_geometry *)payload)->window;
+	} else {
+		const struct rec_own_change *o = (const struct rec_own_change *)payload;
+
+		if (len != sizeof(*o))
+			goto err;
+		r->window = o->window;
+		r->atom = o->atom;
+	}
+	return r;
+err:
+	free(r);
+	return NULL;
+}
+
+/* keeps recording order in the chains */
+static void hash_replies(struct reply **all)
+{
+	unsigned long i;
+
+	replies_size = 1024;
+	while (replies_size < 2 * nr_replies)
+		replies_size *= 2;
+	replies = xnew0(struct reply *, replies_size);
+	for (i = nr_replies; i > 0; i--) {
+		struct reply *r = all[i - 1];
+		unsigned int h = reply_hash(r->kind, r->window, r->atom, r->type);
+
+		r->next = replies[h];
+		replies[h] = r;
+	}
+}
+
+static int read_header(void)
+{
+	char magic[8];
+	unsigned int long_size, nr_atoms;
+
+	if (fread(magic, 1, 8, replay_fp) != 8 || memcmp(magic, REPLAY_MAGIC, 8))
+		return -1;
+	if (fread(&long_size, sizeof(long_size), 1, replay_fp) != 1 || long_size != sizeof(long))
+		return -1;
+	if (fread(&rec_root, sizeof(rec_root), 1, replay_fp) != 1)
+		return -1;
+	if (fread(&nr_atoms, sizeof(nr_atoms), 1, replay_fp) != 1 || nr_atoms != NR_ATOMS)
+		return -1;
+	if (fread(rec_atoms, sizeof(Atom), NR_ATOMS, replay_fp) != NR_ATOMS)
+		return -1;
+	return 0;
+}
+
+int replay_play_open(const char *filename)
+{
+	struct reply **all = NULL;
+	unsigned long alloc = 0;
+	char *payload;
+	unsigned int len;
+	int kind, rc;
+
+	replay_fp = fopen(filename, "r");
+	if (replay_fp == NULL)
+		return -1;
+	if (read_header()) {
+		d_print("%s: bad header\n", filename);
+		goto err;
+	}
+	while ((rc = read_record(&kind, &payload, &len)) == 0) {
+		struct reply *r;
+
+		switch (kind) {
+		case REC_BATCH:
+			rc = load_batch(payload, len);
+			free(payload);
+			break;
+		case REC_WINDOW:
+			if (len == sizeof(Window))
+				memcpy(&rec_window, payload, len);
+			free(payload);
+			break;
+		case REC_PROPERTY:
+		case REC_GEOMETRY:
+		case REC_OWN_CHANGE:
+			r = new_reply(kind, payload, len);
+			if (r == NULL) {
+				free(payload);
+				rc = -1;
+				break;
+			}
+			if (nr_replies == alloc) {
+				alloc = alloc ? alloc * 2 : 1024;
+				all = xrenew(struct reply *, all, alloc);
+			}
+			all[nr_replies++] = r;
+			break;
+		default:
+			free(payload);
+			rc = -1;
+		}
+		if (rc)
+			break;
+	}
+	/* recording of a killed pager may end with a partial record */
+	if (rc)
+		fprintf(stderr, "replay: %s is truncated or corrupted, using %d batches\n",
+				filename, nr_batches);
+	hash_replies(all);
+	free(all);
+	fclose(replay_fp);
+	replay_fp = NULL;
+
+	replay_mode = REPLAY_PLAY;
+	start_time = time_us();
+	return 0;
+err:
+	fclose(replay_fp);
+	replay_fp = NULL;
+	return -1;
+}
+
+int replay_read_batch(struct event_batch *batch)
+{
+	struct batch *b;
+	int i;
+
+	if (cur_seq == nr_batches)
+		return -1;
+	b = &batches[cur_seq++];
+	if (batch->alloc < b->nr) {
+		batch->alloc = b->nr;
+		batch->events = xrenew(XEvent, batch->events, batch->alloc);
+	}
+	for (i = 0; i < b->nr; i++) {
+		XEvent *e = &batch->events[i];
+
+		*e = b->events[i];
+		e->xany.display = display;
+		e->xany.window = live_win(e->xany.window);
+		switch (e->type) {
+		case PropertyNotify:
+			e->xproperty.atom = live_atom(e->xproperty.atom);
+			break;
+		case ConfigureNotify:
+			e->xconfigure.event = live_win(e->xconfigure.event);
+			break;
+		case ClientMessage:
+			e->xclient.message_type = live_atom(e->xclient.message_type);
+			break;
+		}
+	}
+	batch->nr = b->nr;
+	nr_events += b->nr;
+	return 0;
+}
+
+/* latest reply recorded before the current batch, or the first one after it */
+static struct reply *lookup(int kind, Window window, Atom atom, Atom type)
+{
+	struct reply *r, *found = NULL;
+
+	for (r = replies[reply_hash(kind, window, atom, type)]; r; r = r->next) {
+		if (r->kind != kind || r->window != window || r->atom != atom || r->type != type)
+			continue;
+		if (r->seq > cur_seq)
+			return found ? found : r;
+		found = r;
+	}
+	return found;
+}
+
+int replay_get_property(Window window, Atom type, Atom property, char **prop_ret, int *nr_ret)
+{
+	const struct rec_property *p;
+	struct reply *r;
+	unsigned int size;
+	char *data;
+	int i;
+
+	r = lookup(REC_PROPERTY, recorded_win(window), recorded_atom(property), recorded_atom(type));
+	if (r == NULL) {
+		nr_misses++;
+		return -2;
+	}
+	p = (const struct rec_property *)r->payload;
+	if (p->rc)
+		return p->rc;
+
+	/* XGetWindowProperty adds a terminating zero too */
+	size = r->len - sizeof(*p);
+	data = xmalloc(size + 1);
+	memcpy(data, r->payload + sizeof(*p), size);
+	data[size] = 0;
+	if (type == XA_ATOM || type == XA_WINDOW) {
+		unsigned long *l = (unsigned long *)data;
+
+		for (i = 0; i < p->nr; i++)
+			l[i] = type == XA_ATOM ? live_atom(l[i]) : live_win(l[i]);
+	}
+	*prop_ret = data;
+	*nr_ret = p->nr;
+	return 0;
+}
+
+int replay_get_geometry(Window window, int *x, int *y, int *w, int *h)
+{
+	const struct rec_geometry *g;
+	struct reply *r;
+
+	r = lookup(REC_GEOMETRY, recorded_win(window), None, None);
+	if (r == NULL) {
+		nr_misses++;
+		return -1;
+	}
+	g = (const struct rec_geometry *)r->payload;
+	if (g->rc)
+		return g->rc;
+	*x = g->x;
+	*y = g->y;
+	*w = g->w;
+	*h = g->h;
+	return 0;
+}
+
+int replay_is_own_change(const XPropertyEvent *event)
+{
+	Window window = recorded_win(event->window);
+	Atom atom = recorded_atom(event->atom);
+	struct reply *r;
+
+	for (r = replies[reply_hash(REC_OWN_CHANGE, window, atom, None)]; r; r = r->next) {
+		if (r->kind == REC_OWN_CHANGE && r->window == window && r->atom == atom &&
+				((const struct rec_own_change *)r->payload)->serial == event->serial)
+			return 1;
+	}
+	return 0;
+}
+
+void replay_print_summary(void)
+{
+	if (replay_mode != REPLAY_PLAY)
+		return;
+	fprintf(stderr, "replay: %d batches, %lu events, %lu replies, %lu missing, %llu ms\n",
+			cur_seq, nr_events, nr_replies, nr_misses,
+			(time_us() - start_time) / 1000);
+}
+
+void replay_close(void)
+{
+	unsigned int h;
+	int i;
+
+	if (replay_fp) {
+		fclose(replay_fp);
+		replay_fp = NULL;
+	}
+	for (h = 0; h < replies_size; h++) {
+		struct reply *r = replies[h];
+
+		while (r) {
+			struct reply *next = r->next;
+
+			free(r->payload);
+			free(r);
+			r = next;
+		}
+	}
+	free(replies);
+	replies = NULL;
+	replies_size = 0;
+	for (i = 0; i < nr_batches; i++)
+		free(batches[i].events);
+	free(batches);
+	batches = NULL;
+	nr_batches = 0;
+	replay_mode = REPLAY_OFF;
+}
@@ -0,0 +1,83 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef _REPLAY_H
+#define _REPLAY_H
+
+#include <event.h>
+
+#include <X11/Xlib.h>
+
+/*
+ * Record and replay of a pager session.
+ *
+ * Recording logs every event batch read in loop() plus the replies x.c
+ * got for properties, window geometry and own property changes. Replay
+ * feeds the batches back and serves those replies from the file, so no
+ * window manager is needed. Drawing still goes to a real X server (Xvfb
+ * is fine).
+ *
+ * File format (host byte order, not portable between architectures):
+ *
+ *   header: "NWPREC1\n", u32 sizeof(long), Window root, u32 nr_atoms,
+ *           Atom atoms[nr_atoms] (values of enum atom_index)
+ *   record: u8 kind, u32 length, payload
+ *
+ * A reply is served from the latest record made before the current batch
+ * or, if there is none, the first one after it. Window and atom ids are
+ * translated between the recorded and the live server.
+ */
+
+enum replay_mode {
+	REPLAY_OFF,
+	REPLAY_RECORD,
+	REPLAY_PLAY
+};
+
+extern enum replay_mode replay_mode;
+
+/* call after x_init() */
+extern int replay_record_open(const char *filename);
+/* reads the whole file */
+extern int replay_play_open(const char *filename);
+extern void replay_close(void);
+
+/* the pager window. its own properties are never replayed */
+extern void replay_set_window(Window window);
+extern int replay_is_live_window(Window window);
+
+extern void replay_record_batch(const XEvent *events, int nr);
+/* returns -1 after the last batch */
+extern int replay_read_batch(struct event_batch *batch);
+
+/* @data: @nr elements of @format bits, as returned by XGetWindowProperty */
+extern void replay_record_property(Window window, Atom type, Atom property, int rc,
+		const char *data, int nr, int format);
+/* returns like x_get_property(). *prop_ret must be freed with XFree */
+extern int replay_get_property(Window window, Atom type, Atom property, char **prop_ret, int *nr_ret);
+
+extern void replay_record_geometry(Window window, int rc, int x, int y, int w, int h);
+extern int replay_get_geometry(Window window, int *x, int *y, int *w, int *h);
+
+/* only own changes are recorded */
+extern void replay_record_own_change(const XPropertyEvent *event);
+extern int replay_is_own_change(const XPropertyEvent *event);
+
+/* prints batches, events and replies without a recording to stderr */
+extern void replay_print_summary(void);
+
+#endif
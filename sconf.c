@@ -49,10 +49,10 @@ static void __NORETURN die(const char *format, ...)
 
 static void option_free(struct sconf_option *opt)
 {
-	free(opt->name);
+	mem_free(MEM_CONFIG, opt->name);
 	if (opt->type == CO_STR)
-		free(opt->str_val);
-	free(opt);
+		mem_free(MEM_CONFIG, opt->str_val);
+	mem_free(MEM_CONFIG, opt);
 }
 
 static void add_option(struct sconf_option *new)
@@ -97,8 +97,8 @@ static int handle_line(void *data, const char *line)
 	if (ns == line)
 		goto syntax;
 
-	opt = xnew(struct sconf_option, 1);
-	opt->name = xstrndup(ns, line - ns);
+	opt = mem_new(MEM_CONFIG, struct sconf_option, 1);
+	opt->name = mem_strndup(MEM_CONFIG, ns, line - ns);
 
 	while (isspace(*line))
 		line++;
@@ -129,7 +129,7 @@ static int handle_line(void *data, const char *line)
 		line++;
 		pos = line;
 
-		str = xnew(char, strlen(line));
+		str = mem_new(MEM_CONFIG, char, strlen(line));
 		while (1) {
 			int ch = *pos++;
 
@@ -138,7 +138,7 @@ static int handle_line(void *data, const char *line)
 			if (ch == '\\')
 				ch = *pos++;
 			if (ch == 0) {
-				free(str);
+				mem_free(MEM_CONFIG, str);
 				goto syntax;
 			}
 			str[i++] = ch;
@@ -198,7 +198,7 @@ static void buffer_for_each_line(const char *buf, int size,
 
 		if (len >= line_size) {
 			line_size = len + 1;
-			line = xrenew(char, line, line_size);
+			line = mem_renew(MEM_CONFIG, char, line, line_size);
 		}
 		memcpy(line, buf + pos, len);
 		line[len] = 0;
@@ -207,7 +207,7 @@ static void buffer_for_each_line(const char *buf, int size,
 		if (cb(data, line))
 			break;
 	}
-	free(line);
+	mem_free(MEM_CONFIG, line);
 }
 
 static int file_for_each_line(const char *filename,
@@ -262,13 +262,10 @@ void sconf_free(void)
 	while (item != &head) {
 		opt = container_of(item, struct sconf_option, node);
 		next = item->next;
-
-		if (opt->type == CO_STR)
-			free(opt->str_val);
-		free(opt);
-
+		option_free(opt);
 		item = next;
 	}
+	list_init(&head);
 }
 
 static struct sconf_option *find_opt(const char *name, int type)
@@ -297,7 +294,7 @@ int sconf_get_str_option(const char *name, char **value)
 	struct sconf_option *opt = find_opt(name, CO_STR);
 	if (opt == NULL)
 		return 0;
-	*value = xstrdup(opt->str_val);
+	*value = mem_strdup(MEM_CONFIG, opt->str_val);
 	return 1;
 }
 
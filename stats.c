@@ -0,0 +1,131 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include <stats.h>
+
+#if DEBUG > 0
+
+#include <x.h>
+#include <xmalloc.h>
+
+#include <stdio.h>
+#include <string.h>
+
+struct stats stats;
+
+/* NextRequest() at last stats_reset() */
+static unsigned long first_request = 1;
+struct hist event_to_paint = HIST_INIT("event to paint");
+struct hist refresh_time = HIST_INIT("refresh");
+struct hist click_latency = HIST_INIT("click latency");
+
+static const char *event_names[LASTEvent] = {
+	[KeyPress] = "KeyPress",
+	[KeyRelease] = "KeyRelease",
+	[ButtonPress] = "ButtonPress",
+	[ButtonRelease] = "ButtonRelease",
+	[MotionNotify] = "MotionNotify",
+	[EnterNotify] = "EnterNotify",
+	[LeaveNotify] = "LeaveNotify",
+	[FocusIn] = "FocusIn",
+	[FocusOut] = "FocusOut",
+	[KeymapNotify] = "KeymapNotify",
+	[Expose] = "Expose",
+	[GraphicsExpose] = "GraphicsExpose",
+	[NoExpose] = "NoExpose",
+	[VisibilityNotify] = "VisibilityNotify",
+	[CreateNotify] = "CreateNotify",
+	[DestroyNotify] = "DestroyNotify",
+	[UnmapNotify] = "UnmapNotify",
+	[MapNotify] = "MapNotify",
+	[MapRequest] = "MapRequest",
+	[ReparentNotify] = "ReparentNotify",
+	[ConfigureNotify] = "ConfigureNotify",
+	[ConfigureRequest] = "ConfigureRequest",
+	[GravityNotify] = "GravityNotify",
+	[ResizeRequest] = "ResizeRequest",
+	[CirculateNotify] = "CirculateNotify",
+	[CirculateRequest] = "CirculateRequest",
+	[PropertyNotify] = "PropertyNotify",
+	[SelectionClear] = "SelectionClear",
+	[SelectionRequest] = "SelectionRequest",
+	[SelectionNotify] = "SelectionNotify",
+	[ColormapNotify] = "ColormapNotify",
+	[ClientMessage] = "ClientMessage",
+	[MappingNotify] = "MappingNotify"
+};
+
+void stats_dump(const char *filename)
+{
+	FILE *f = stderr;
+	int i;
+
+	if (filename) {
+		f = fopen(filename, "a");
+		if (f == NULL) {
+			perror(filename);
+			return;
+		}
+	}
+
+	fprintf(f, "requests:         %lu\n", NextRequest(display) - first_request);
+	fprintf(f, "round trips:      %lu\n", stats.round_trips);
+	fprintf(f, "property bytes:   %lu\n", stats.property_bytes);
+	fprintf(f, "full repaints:    %lu\n", stats.full_repaints);
+	fprintf(f, "partial repaints: %lu\n", stats.partial_repaints);
+	fprintf(f, "popup repaints:   %lu\n", stats.popup_repaints);
+	fprintf(f, "refreshes:        %lu (%lu requests, %lu clients fetched)\n",
+			stats.refreshes, stats.refresh_requests, stats.clients_fetched);
+	for (i = 0; i < LASTEvent; i++) {
+		if (stats.events[i])
+			fprintf(f, "%-17s %lu\n", event_names[i] ? event_names[i] : "?", stats.events[i]);
+	}
+	hist_print(f, &event_to_paint);
+	hist_print(f, &refresh_time);
+	hist_print(f, &click_latency);
+	fprintf(f, "memory:            %10s %10s\n", "now", "max");
+	for (i = 0; i < NR_MEM_TYPES; i++)
+		fprintf(f, "  %-16s %10ld %10ld\n", mem_counters[i].name,
+				mem_counters[i].bytes, mem_counters[i].max);
+	/* end of the dump */
+	fputc('\n', f);
+
+	if (filename)
+		fclose(f);
+	else
+		fflush(f);
+}
+
+static void hist_reset(struct hist *h)
+{
+	const char *name = h->name;
+
+	memset(h, 0, sizeof(*h));
+	h->name = name;
+}
+
+void stats_reset(void)
+{
+	memset(&stats, 0, sizeof(stats));
+	hist_reset(&event_to_paint);
+	hist_reset(&refresh_time);
+	hist_reset(&click_latency);
+	mem_reset_max();
+	first_request = NextRequest(display);
+}
+
+#endif
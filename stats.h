@@ -0,0 +1,77 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef _STATS_H
+#define _STATS_H
+
+/*
+ * Counters and latency histograms. Dumped on SIGUSR1 and at exit, reset
+ * on SIGUSR2. Everything compiles to nothing when DEBUG is 0.
+ */
+
+#if DEBUG > 0
+
+#include <hist.h>
+
+#include <X11/Xlib.h>
+
+struct stats {
+	/* requests which wait for a reply. the display is not synchronous,
+	 * so other requests are not round trips. Xft font loading is not
+	 * counted */
+	unsigned long round_trips;
+	/* bytes of property data read */
+	unsigned long property_bytes;
+	/* pager_update() */
+	unsigned long full_repaints;
+	/* single desktop cell, see redraw_desk() */
+	unsigned long partial_repaints;
+	unsigned long popup_repaints;
+	unsigned long refreshes;
+	/* requests used by refreshes */
+	unsigned long refresh_requests;
+	unsigned long clients_fetched;
+	unsigned long events[LASTEvent];
+};
+
+extern struct stats stats;
+
+/* from reading an event batch to the end of the paint it caused */
+extern struct hist event_to_paint;
+/* pager_refresh_start() to pager_refresh_finish() */
+extern struct hist refresh_time;
+/* from reading the batch to the end of handling a button event in it,
+ * an upper bound for click latency */
+extern struct hist click_latency;
+
+#define STAT_INC(name)		(stats.name++)
+#define STAT_ADD(name, n)	(stats.name += (n))
+#define STAT_HIST(h, us)	hist_add(&(h), (us))
+
+/* @filename: NULL = stderr. a dump ends with an empty line */
+extern void stats_dump(const char *filename);
+extern void stats_reset(void);
+
+#else
+
+#define STAT_INC(name)		do { } while (0)
+#define STAT_ADD(name, n)	do { } while (0)
+#define STAT_HIST(h, us)	do { } while (0)
+
+#endif
+
+#endif
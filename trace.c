@@ -0,0 +1,82 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#include <trace.h>
+#include <hist.h>
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <unistd.h>
+
+FILE *trace_fp = NULL;
+
+static int trace_pid;
+static int nr_trace_events;
+/* open B events */
+static int trace_depth;
+
+int trace_open(const char *filename)
+{
+	trace_fp = fopen(filename, "w");
+	if (trace_fp == NULL)
+		return -1;
+	trace_pid = getpid();
+	nr_trace_events = 0;
+	trace_depth = 0;
+	/* array format, the closing ] is optional */
+	fputs("[\n", trace_fp);
+	fflush(trace_fp);
+	return 0;
+}
+
+void trace_close(void)
+{
+	if (trace_fp == NULL)
+		return;
+	fputs("\n]\n", trace_fp);
+	fclose(trace_fp);
+	trace_fp = NULL;
+}
+
+void trace_write(int phase, const char *name, const char *args_fmt, ...)
+{
+	if (trace_fp == NULL)
+		return;
+
+	fprintf(trace_fp, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu,\"pid\":%d,\"tid\":%d",
+			nr_trace_events++ ? ",\n" : "",
+			name, phase, time_us(), trace_pid, trace_pid);
+	if (args_fmt) {
+		va_list ap;
+
+		fputs(",\"args\":{", trace_fp);
+		va_start(ap, args_fmt);
+		vfprintf(trace_fp, args_fmt, ap);
+		va_end(ap);
+		fputc('}', trace_fp);
+	}
+	fputc('}', trace_fp);
+
+	/* the pager is usually killed. a file which ends after a complete
+	 * top level span still loads */
+	if (phase == 'B') {
+		trace_depth++;
+	} else if (--trace_depth <= 0) {
+		trace_depth = 0;
+		fflush(trace_fp);
+	}
+}
@@ -0,0 +1,47 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA
+ * 02111-1307, USA.
+ */
+
+#ifndef _TRACE_H
+#define _TRACE_H
+
+#include <stdio.h>
+
+/*
+ * Chrome trace_event JSON (chrome://tracing, Perfetto). Spans are written
+ * as B/E event pairs. Nothing is written unless trace_open() succeeded.
+ * The file is flushed after each top level span and is valid even if
+ * trace_close() is never called.
+ */
+
+extern FILE *trace_fp;
+
+extern int trace_open(const char *filename);
+extern void trace_close(void);
+
+extern void trace_write(int phase, const char *name, const char *args_fmt, ...)
+	__attribute__((format(printf, 3, 4)));
+
+/* @args_fmt: NULL or printf format for members of the "args" object,
+ * for example "\"window\":%lu"
+ */
+#define trace_begin(name, ...) \
+	do { if (trace_fp) trace_write('B', name, __VA_ARGS__); } while (0)
+
+#define trace_end(name) \
+	do { if (trace_fp) trace_write('E', name, NULL); } while (0)
+
+#endif
@@ -20,6 +20,9 @@
 #include <x.h>
 #include <xmalloc.h>
 #include <debug.h>
+#include <stats.h>
+#include <trace.h>
+#include <replay.h>
 
 #include <X11/Xlib.h>
 #include <X11/Xatom.h>
@@ -144,18 +147,24 @@ static int client_msg(Window to_window, Window window,
 	}
 }
 
-static int get_property_array(Window window, Atom type, Atom property, char **prop_ret, int *nr_ret)
+static int fetch_property(Window window, Atom type, Atom property, char **prop_ret, int *nr_ret, int *format_ret)
 {
 	int format;
 	unsigned long nr, bytes;
 	Atom ret_type;
 	int rc;
 
+	STAT_INC(round_trips);
+	trace_begin("XGetWindowProperty", "\"window\":%lu,\"atom\":%lu",
+			(unsigned long)window, (unsigned long)property);
 	rc = XGetWindowProperty(display, window,
 			property,
 			0, 32 * 1024, False,
 			type, &ret_type, &format, &nr, &bytes,
 			(unsigned char **)prop_ret);
+	trace_end("XGetWindowProperty");
+	if (rc == Success)
+		STAT_ADD(property_bytes, nr * format / 8);
 	if (rc != Success) {
 		d_print("XGetWindowProperty: window: 0x%x, property: 0x%x, return code: %d\n",
 				(unsigned int)window,
@@ -171,9 +180,34 @@ static int get_property_array(Window window, Atom type, Atom property, char **pr
 		return -1;
 	}
 	*nr_ret = nr;
+	*format_ret = format;
 	return 0;
 }
 
+/* free *@prop_ret with free_property() */
+static int get_property_array(Window window, Atom type, Atom property, char **prop_ret, int *nr_ret)
+{
+	int rc, format = 0;
+
+	if (replay_mode == REPLAY_PLAY && !replay_is_live_window(window)) {
+		rc = replay_get_property(window, type, property, prop_ret, nr_ret);
+	} else {
+		rc = fetch_property(window, type, property, prop_ret, nr_ret, &format);
+		if (replay_mode == REPLAY_RECORD)
+			replay_record_property(window, type, property, rc,
+					rc ? NULL : *prop_ret, rc ? 0 : *nr_ret, format);
+	}
+	if (rc == 0)
+		MEM_ALLOC(MEM_PROPERTY, *prop_ret);
+	return rc;
+}
+
+static void free_property(char *p)
+{
+	MEM_FREE(MEM_PROPERTY, p);
+	XFree(p);
+}
+
 static int get_str_property(Window window, Atom str_type, Atom property, char **prop_ret)
 {
 	int rc, n;
@@ -183,7 +217,7 @@ static int get_str_property(Window window, Atom str_type, Atom property, char **
 	if (rc)
 		return rc;
 	*prop_ret = xstrdup(p);
-	XFree(p);
+	free_property(p);
 	return 0;
 }
 
@@ -210,7 +244,7 @@ static int get_str_array_property(Window window, Atom str_type, Atom property, c
 		d_print("'%s'\n", a[i]);
 	}
 	a[i] = NULL;
-	XFree(p);
+	free_property(p);
 
 	*prop_ret = a;
 	*nr_ret = count;
@@ -224,6 +258,7 @@ static int x_window_find_top_parent(Window window, Window *top)
 		Window *c;
 		unsigned int n;
 
+		STAT_INC(round_trips);
 		if (!XQueryTree(display, window, &root, &parent, &c, &n))
 			return -1;
 		if (c)
@@ -251,8 +286,10 @@ void x_exit(void)
 
 Atom x_get_atom(enum atom_index idx)
 {
-	if (atom_values[idx] == 0)
+	if (atom_values[idx] == 0) {
+		STAT_INC(round_trips);
 		atom_values[idx] = XInternAtom(display, atom_names[idx], False);
+	}
 	return atom_values[idx];
 }
 
@@ -267,7 +304,7 @@ int x_get_property(Window window, Atom type, Atom property, size_t type_size, vo
 	*prop_ret = xmalloc(n * type_size);
 	memcpy(*prop_ret, p, n * type_size);
 	*nr_ret = n;
-	XFree(p);
+	free_property(p);
 	return 0;
 }
 
@@ -279,10 +316,12 @@ int x_get_property_nr(Window window, Atom type, Atom property, size_t type_size,
 	rc = get_property_array(window, type, property, &p, &n);
 	if (rc)
 		return rc;
-	if (n != nr)
+	if (n != nr) {
+		free_property(p);
 		return -2;
+	}
 	memcpy(prop_ret, p, nr * type_size);
-	XFree(p);
+	free_property(p);
 	return 0;
 }
 
@@ -306,13 +345,108 @@ int x_get_utf8_string_array_property(Window window, Atom property, char ***prop_
 	return get_str_array_property(window, x_get_atom(UTF8_STRING), property, prop_ret, nr_ret);
 }
 
+#define NR_OWN_WRITES 32
+#define NR_ECHO_COUNTS 16
+
+/* recent x_set_property() calls, ring buffer. window is None once the
+ * PropertyNotify of the write has been seen
+ */
+static struct {
+	Window window;
+	Atom atom;
+	/* serial of the ChangeProperty request */
+	unsigned long serial;
+} own_writes[NR_OWN_WRITES];
+static int own_writes_pos = 0;
+
+/* PropertyNotify events dropped by x_is_own_property_change(), per atom */
+static struct {
+	Atom atom;
+	unsigned long count;
+} echo_counts[NR_ECHO_COUNTS];
+
+/* call right before the ChangeProperty request. only its own serial is
+ * recorded: the next request would also cover a PropertyNotify from the
+ * WM reacting to our write
+ */
+static void own_write(Window window, Atom atom)
+{
+	int i = own_writes_pos;
+
+	own_writes_pos = (own_writes_pos + 1) % NR_OWN_WRITES;
+	own_writes[i].window = window;
+	own_writes[i].atom = atom;
+	own_writes[i].serial = NextRequest(display);
+}
+
 int x_set_property(Window window, Atom type, Atom property, int format, const void *prop, int nr)
 {
+	trace_begin("XChangeProperty", "\"window\":%lu,\"atom\":%lu",
+			(unsigned long)window, (unsigned long)property);
 	/* return value not documented. fucking xlib */
+	own_write(window, property);
 	XChangeProperty(display, window, property, type, format, PropModeReplace, prop, nr);
+	trace_end("XChangeProperty");
 	return 0;
 }
 
+static void count_echo(Atom atom)
+{
+	int i;
+
+	for (i = 0; i < NR_ECHO_COUNTS; i++) {
+		if (echo_counts[i].atom == atom || echo_counts[i].atom == None) {
+			echo_counts[i].atom = atom;
+			echo_counts[i].count++;
+			return;
+		}
+	}
+}
+
+int x_is_own_property_change(const XPropertyEvent *event)
+{
+	int i;
+
+	/* serials of the recording, see replay.h */
+	if (replay_mode == REPLAY_PLAY) {
+		if (!replay_is_own_change(event))
+			return 0;
+		count_echo(event->atom);
+		return 1;
+	}
+	for (i = 0; i < NR_OWN_WRITES; i++) {
+		if (own_writes[i].window == event->window &&
+				own_writes[i].atom == event->atom &&
+				event->serial == own_writes[i].serial) {
+			/* one write, one PropertyNotify */
+			own_writes[i].window = None;
+			count_echo(event->atom);
+			if (replay_mode == REPLAY_RECORD)
+				replay_record_own_change(event);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+void x_print_echo_stats(void)
+{
+#if DEBUG > 0
+	int i;
+
+	for (i = 0; i < NR_ECHO_COUNTS && echo_counts[i].atom != None; i++) {
+		char *name;
+
+		STAT_INC(round_trips);
+		name = XGetAtomName(display, echo_counts[i].atom);
+
+		d_print("own %s changes ignored: %lu\n", name ? name : "?", echo_counts[i].count);
+		if (name)
+			XFree(name);
+	}
+#endif
+}
+
 int x_is_netwm_compatible_wm_running(void)
 {
 	Window win;
@@ -369,6 +503,10 @@ int x_get_client_list_for_desktop(int stacking, int desktop, Window **windows, i
 	return 0;
 }
 
+/* last layout written by x_set_desktop_layout() */
+static int layout_columns = 0;
+static int layout_rows = 0;
+
 int x_set_desktop_layout(int columns, int rows)
 {
 	unsigned long data[4];
@@ -384,6 +522,8 @@ int x_set_desktop_layout(int columns, int rows)
 	data[1] = columns;
 	data[2] = rows;
 	data[3] = _NET_WM_TOPLEFT;
+	layout_columns = columns;
+	layout_rows = rows;
 	if (x_set_cardinal_property(DefaultRootWindow(display), x_get_atom(_NET_DESKTOP_LAYOUT), data, 4))
 		return -1;
 	return 0;
@@ -435,7 +575,12 @@ int x_get_desktop_layout(int *columns, int *rows)
 			properties_set_by_idiot = 1;
 		}
 	}
-	if (properties_set_by_idiot)
+	/* fix the properties only once. if the WM does not accept the
+	 * number of desktops we asked for the layout stays inconsistent and
+	 * rewriting it would just cause another PropertyNotify
+	 */
+	if (properties_set_by_idiot &&
+			(c != layout_columns || r != layout_rows))
 		x_set_desktop_layout(c, r);
 
 	*columns = c;
@@ -576,7 +721,7 @@ int x_window_get_title(Window window, char **title)
 				return -1;
 		}
 	}
-	*title = xstrdup(tmp);
+	*title = mem_strdup(MEM_TITLES, tmp);
 	XFree(tmp);
 	return 0;
 }
@@ -594,6 +739,7 @@ int x_window_set_geometry(Window window, int flags, int x, int y, unsigned int w
 		return -1;
 	}
 
+	STAT_INC(round_trips);
 	if (XGetWMNormalHints(display, window, &hints, &user_supplied) == False)
 		hints.flags = 0;
 
@@ -661,11 +807,13 @@ int x_window_set_geometry(Window window, int flags, int x, int y, unsigned int w
 	return 0;
 }
 
-int x_window_get_geometry(Window window, int *x, int *y, int *w, int *h)
+static int get_geometry(Window window, int *x, int *y, int *w, int *h)
 {
 	XWindowAttributes a;
 	Window child_ret;
 
+	/* GetWindowAttributes + GetGeometry */
+	STAT_ADD(round_trips, 2);
 	if (XGetWindowAttributes(display, window, &a) != True) {
 		d_print("could not get attributes of window 0x%x\n", (int)window);
 		return -1;
@@ -677,6 +825,7 @@ int x_window_get_geometry(Window window, int *x, int *y, int *w, int *h)
  * 		return -1;
  * 	}
  */
+	STAT_INC(round_trips);
 	if (XTranslateCoordinates(display, window, DefaultRootWindow(display), a.x, a.y, x, y, &child_ret) == True) {
 		*w = a.width;
 		*h = a.height;
@@ -687,6 +836,24 @@ int x_window_get_geometry(Window window, int *x, int *y, int *w, int *h)
 	return 0;
 }
 
+int x_window_get_geometry(Window window, int *x, int *y, int *w, int *h)
+{
+	int rc;
+
+	if (replay_mode == REPLAY_PLAY && !replay_is_live_window(window))
+		return replay_get_geometry(window, x, y, w, h);
+	trace_begin("x_window_get_geometry", "\"window\":%lu", (unsigned long)window);
+	rc = get_geometry(window, x, y, w, h);
+	trace_end("x_window_get_geometry");
+	if (replay_mode == REPLAY_RECORD) {
+		if (rc)
+			replay_record_geometry(window, rc, 0, 0, 0, 0);
+		else
+			replay_record_geometry(window, rc, *x, *y, *w, *h);
+	}
+	return rc;
+}
+
 int x_window_set_type(Window window, enum window_type type)
 {
 	Atom atom;
@@ -832,14 +999,14 @@ int x_window_get_icon(Window window, int *width, int *height, char **data)
 		goto err;
 	d_print("n = %d, w * h = %d, w = %d, h = %d\n", nr, w * h, w, h);
 
-	*data = xnew(char, w * h * 4);
+	*data = mem_new(MEM_ICONS, char, w * h * 4);
 	memcpy(*data, tmp + 8, w * h * 4);
 	*width = w;
 	*height = h;
-	XFree(tmp);
+	free_property(tmp);
 	return 0;
 err:
-	XFree(tmp);
+	free_property(tmp);
 	return -1;
 }
 
@@ -852,6 +1019,8 @@ int x_window_set_aspect(Window window, int x, int y)
 	hints.min_aspect.y = y;
 	hints.max_aspect.x = x;
 	hints.max_aspect.y = y;
+	/* one ChangeProperty */
+	own_write(window, XA_WM_NORMAL_HINTS);
 	XSetWMNormalHints(display, window, &hints);
 	return 0;
 }
@@ -874,6 +1043,8 @@ int x_parse_color(const char *name, unsigned long *color)
 {
 	XColor ecolor;
 
+	/* names other than #rrggbb are looked up by the server */
+	STAT_ADD(round_trips, name[0] == '#' ? 1 : 2);
 	if (!XParseColor(display, DefaultColormap(display, DefaultScreen(display)), name, &ecolor)) {
 		d_print("unknown color `%s'\n", name);
 		return -1;
@@ -901,11 +1072,11 @@ int x_get_window_by_name(const char *name, Window *window)
 			continue;
 		if (strcmp(win_name, name) == 0) {
 			*window = windows[i];
-			free(win_name);
+			mem_free(MEM_TITLES, win_name);
 			free(windows);
 			return 1;
 		}
-		free(win_name);
+		mem_free(MEM_TITLES, win_name);
 	}
 	free(windows);
 	return 0;
@@ -20,6 +20,8 @@
 #ifndef _X_H
 #define _X_H
 
+#include <netwm.h>
+
 #include <X11/Xlib.h>
 #include <X11/Xatom.h>
 #include <string.h>
@@ -89,19 +91,6 @@ enum atom_index {
 	NR_ATOMS
 };
 
-#define WINDOW_STATE_MODAL		(1 << 0)
-#define WINDOW_STATE_STICKY		(1 << 1)
-#define WINDOW_STATE_MAXIMIZED_VERT	(1 << 2)
-#define WINDOW_STATE_MAXIMIZED_HORZ	(1 << 3)
-#define WINDOW_STATE_SHADED		(1 << 4)
-#define WINDOW_STATE_SKIP_TASKBAR	(1 << 5)
-#define WINDOW_STATE_SKIP_PAGER		(1 << 6)
-#define WINDOW_STATE_HIDDEN		(1 << 7)
-#define WINDOW_STATE_FULLSCREEN		(1 << 8)
-#define WINDOW_STATE_ABOVE		(1 << 9)
-#define WINDOW_STATE_BELOW		(1 << 10)
-#define WINDOW_STATE_DEMANDS_ATTENTION	(1 << 11)
-
 enum state_action {
 	/* unset propery */
 	_NET_WM_STATE_REMOVE,
@@ -111,17 +100,6 @@ enum state_action {
 	_NET_WM_STATE_TOGGLE
 };
 
-enum window_type {
-	WINDOW_TYPE_DESKTOP,
-	WINDOW_TYPE_DOCK,
-	WINDOW_TYPE_TOOLBAR,
-	WINDOW_TYPE_MENU,
-	WINDOW_TYPE_UTILITY,
-	WINDOW_TYPE_SPLASH,
-	WINDOW_TYPE_DIALOG,
-	WINDOW_TYPE_NORMAL
-};
-
 enum strut_type {
 	STRUT_TYPE_LEFT,
 	STRUT_TYPE_RIGHT,
@@ -183,6 +161,13 @@ extern int x_get_utf8_string_array_property(Window window, Atom property, char *
 
 extern int x_set_property(Window window, Atom type, Atom property, int format, const void *prop, int nr);
 
+/* returns 1 if @event was caused by a recent x_set_property() call. each
+ * write matches only the one PropertyNotify carrying its serial
+ */
+extern int x_is_own_property_change(const XPropertyEvent *event);
+/* d_print number of ignored events per atom */
+extern void x_print_echo_stats(void);
+
 static inline int x_set_atom_property(Window window, Atom property, const Atom *prop, int nr)
 {
 	return x_set_property(window, XA_ATOM, property, 32, prop, nr);
@@ -210,6 +195,7 @@ extern int x_get_client_list(int stacking, Window **windows, int *nr_windows);
 extern int x_get_client_list_for_desktop(int stacking, int desktop, Window **windows, int *nr_windows);
 
 extern int x_set_desktop_layout(int columns, int rows);
+/* fixes inconsistent layout properties, but only once per layout */
 extern int x_get_desktop_layout(int *columns, int *rows);
 
 extern int x_get_desktop_names(char ***namesp);
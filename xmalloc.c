@@ -47,3 +47,33 @@ char *xstrndup(const char *str, size_t n)
 	s[n] = 0;
 	return s;
 }
+
+#if DEBUG > 0
+
+struct mem_counter mem_counters[NR_MEM_TYPES] = {
+	{ "client table" },
+	{ "titles" },
+	{ "icons" },
+	{ "property scratch" },
+	{ "config" },
+	{ "server pixmaps" }
+};
+
+void mem_add(enum mem_type type, long bytes)
+{
+	struct mem_counter *c = &mem_counters[type];
+
+	c->bytes += bytes;
+	if (c->bytes > c->max)
+		c->max = c->bytes;
+}
+
+void mem_reset_max(void)
+{
+	int i;
+
+	for (i = 0; i < NR_MEM_TYPES; i++)
+		mem_counters[i].max = mem_counters[i].bytes;
+}
+
+#endif
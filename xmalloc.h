@@ -25,6 +25,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if DEBUG > 0
+#include <malloc.h>
+#endif
+
 extern void malloc_fail(void) __NORETURN;
 
 #define xnew(type, n)		(type *)xmalloc(sizeof(type) * (n))
@@ -68,4 +72,105 @@ static inline char * __MALLOC xstrdup(const char *str)
 
 extern char * __MALLOC xstrndup(const char *str, size_t n);
 
+/*
+ * Byte counters by category, printed by stats_dump(). Heap blocks are
+ * counted with malloc_usable_size() so allocation and free must use the
+ * same category. Allocate accounted memory with mem_new(), mem_renew(),
+ * mem_strdup() etc. and release it with mem_free(). Accounting compiles
+ * to nothing when DEBUG is 0.
+ */
+enum mem_type {
+	/* clients[], desktop index, hit-test grids, refresh queue */
+	MEM_CLIENTS,
+	MEM_TITLES,
+	MEM_ICONS,
+	/* property data returned by XGetWindowProperty */
+	MEM_PROPERTY,
+	MEM_CONFIG,
+	/* X server side, counted by size instead of pointer */
+	MEM_PIXMAPS,
+	NR_MEM_TYPES
+};
+
+#if DEBUG > 0
+
+struct mem_counter {
+	const char *name;
+	long bytes;
+	/* high-water mark since start or mem_reset_max() */
+	long max;
+};
+
+extern struct mem_counter mem_counters[NR_MEM_TYPES];
+
+extern void mem_add(enum mem_type type, long bytes);
+extern void mem_reset_max(void);
+
+/* memory allocated by someone else, e.g. Xlib. @ptr: NULL or from
+ * malloc(). must not have side effects */
+#define MEM_ALLOC(type, ptr) \
+	do { if (ptr) mem_add(type, malloc_usable_size(ptr)); } while (0)
+#define MEM_FREE(type, ptr) \
+	do { if (ptr) mem_add(type, -(long)malloc_usable_size(ptr)); } while (0)
+#define MEM_ADD(type, bytes)	mem_add(type, bytes)
+
+#else
+
+#define MEM_ALLOC(type, ptr)	do { } while (0)
+#define MEM_FREE(type, ptr)	do { } while (0)
+#define MEM_ADD(type, bytes)	do { } while (0)
+
+#endif
+
+#define mem_new(mtype, type, n)		(type *)mem_malloc(mtype, sizeof(type) * (n))
+#define mem_new0(mtype, type, n)	(type *)mem_malloc0(mtype, sizeof(type) * (n))
+#define mem_renew(mtype, type, ptr, n)	(type *)mem_realloc(mtype, ptr, sizeof(type) * (n))
+
+static inline void * __MALLOC mem_malloc(enum mem_type type, size_t size)
+{
+	void *ptr = xmalloc(size);
+
+	MEM_ALLOC(type, ptr);
+	return ptr;
+}
+
+static inline void * __MALLOC mem_malloc0(enum mem_type type, size_t size)
+{
+	void *ptr = xmalloc0(size);
+
+	MEM_ALLOC(type, ptr);
+	return ptr;
+}
+
+static inline void *mem_realloc(enum mem_type type, void *ptr, size_t size)
+{
+	MEM_FREE(type, ptr);
+	ptr = xrealloc(ptr, size);
+	MEM_ALLOC(type, ptr);
+	return ptr;
+}
+
+static inline char * __MALLOC mem_strdup(enum mem_type type, const char *str)
+{
+	char *s = xstrdup(str);
+
+	MEM_ALLOC(type, s);
+	return s;
+}
+
+static inline char * __MALLOC mem_strndup(enum mem_type type, const char *str, size_t n)
+{
+	char *s = xstrndup(str, n);
+
+	MEM_ALLOC(type, s);
+	return s;
+}
+
+/* @ptr: NULL or from one of the mem_*() functions with same @type */
+static inline void mem_free(enum mem_type type, void *ptr)
+{
+	MEM_FREE(type, ptr);
+	free(ptr);
+}
+
 #endif